@@ -0,0 +1,90 @@
+#include "arena.h"
+
+///\brief Default value for Arena::block_size
+#define ARENA_BLOCK_SIZE (64 << 10)
+
+///\brief Allocates a block of at least size bytes, starting at offset start
+static ArenaBlock *new_block(ArenaBlock *prev, size_t start, size_t size){
+	ArenaBlock *blk = (ArenaBlock *) malloc(sizeof(ArenaBlock) + size);
+	if(blk == NULL) abort();
+	blk->prev = prev;
+	blk->start = start;
+	blk->size = size;
+	blk->used = 0;
+	return blk;
+}
+
+///\brief Arena constructor. block_size may be 0 for the default size.
+Arena *new_arena(size_t block_size){
+	Arena *a = (Arena *) malloc(sizeof(Arena));
+	a->block_size = (block_size > 0) ? block_size : ARENA_BLOCK_SIZE;
+	a->last = new_block(NULL, 0, a->block_size);
+	a->used = 0;
+	a->peak = 0;
+	return a;
+}
+
+///\brief Arena destructor
+void free_arena(Arena *a){
+	ArenaBlock *blk;
+	while(a->last != NULL){
+		blk = a->last;
+		a->last = blk->prev;
+		free(blk);
+	}
+	free(a);
+	return;
+}
+
+///\brief Gets size bytes of uninitialized memory, aligned for any type
+void *arena_alloc(Arena *a, size_t size){
+	size = (size + sizeof(max_align_t)-1) / sizeof(max_align_t) * sizeof(max_align_t);
+	ArenaBlock *blk = a->last;
+	if(blk->size - blk->used < size){
+		//The rest of the current block is lost until the next release or reset
+		a->used = blk->start + blk->size;
+		blk = new_block(blk, a->used, (size > a->block_size) ? size : a->block_size);
+		a->last = blk;
+	}
+	void *ret = (char *) blk->data + blk->used;
+	blk->used += size;
+	a->used = blk->start + blk->used;
+	if(a->used > a->peak) a->peak = a->used;
+	return ret;
+}
+
+///\brief Gets a mark to give back with arena_release() what is allocated after it
+size_t arena_mark(Arena *a){
+	return a->used;
+}
+
+///\brief Gives back everything allocated since the mark
+void arena_release(Arena *a, size_t mark){
+	ArenaBlock *blk;
+	while(a->last->start > mark){
+		blk = a->last;
+		a->last = blk->prev;
+		free(blk);
+	}
+	a->last->used = mark - a->last->start;
+	a->used = mark;
+	return;
+}
+
+/**
+ * \brief Gives back everything, keeping the memory for the next run
+ *
+ * If the run needed several blocks, they are replaced by a single one large
+ * enough for all of them.
+ */
+void arena_reset(Arena *a){
+	size_t size = a->last->start + a->last->size;
+	if(a->last->prev != NULL){
+		arena_release(a, 0);
+		free(a->last);
+		a->last = new_block(NULL, 0, size);
+	}
+	a->last->used = 0;
+	a->used = 0;
+	return;
+}
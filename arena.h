@@ -0,0 +1,41 @@
+#ifndef _ARENA_H_INCLUDED
+#define _ARENA_H_INCLUDED
+
+/**
+ * \file arena.h
+ * \brief Region allocator for the memory of a run
+ *
+ * The Board, the generators and the solvers take their memory from an Arena
+ * instead of allocating every small block on the heap. Nothing is freed one
+ * block at a time: scratch memory is given back with arena_release(), and
+ * everything at once with arena_reset(), so that a batch worker can reuse the
+ * same memory for every run.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+///\brief Chunk of memory from which allocations are cut
+typedef struct _arena_block_struct{
+	struct _arena_block_struct *prev; ///< \brief Previous block, or NULL
+	size_t start; ///< \brief Value of Arena::used at the beginning of this block
+	size_t size; ///< \brief Number of bytes in ArenaBlock::data
+	size_t used; ///< \brief Number of bytes already handed out
+	max_align_t data[]; ///< \brief The memory
+} ArenaBlock;
+
+///\brief Arena data structure
+typedef struct{
+	ArenaBlock *last; ///< \brief Block allocations are cut from
+	size_t block_size; ///< \brief Minimal size of a new block
+	size_t used; ///< \brief Number of bytes handed out since the last reset
+	size_t peak; ///< \brief Highest value reached by Arena::used
+} Arena;
+
+Arena *new_arena(size_t);
+void free_arena(Arena *);
+void *arena_alloc(Arena *, size_t);
+size_t arena_mark(Arena *);
+void arena_release(Arena *, size_t);
+void arena_reset(Arena *);
+#endif //_ARENA_H_INCLUDED
@@ -1,3 +1,5 @@
+#include <string.h>
+#include <sys/mman.h>
 #include "data_struct.h"
 
 ///\brief Simply gets the opposite Direction
@@ -25,32 +27,55 @@ Yx new_yx(int y, int x){
 	return c;
 }
 
-///\brief Board constructor
-Board *new_board(const int h, const int w, Yx start){
-	Board *b = (Board *) malloc(sizeof(Board));
+/**
+ * \brief Board constructor
+ *
+ * \param h height
+ * \param w width
+ * \param start where the Player will start
+ * \param layout how the cells are stored
+ * \param *arena where to allocate the board; if NULL, the board gets its own
+ */
+Board *new_board(const int h, const int w, Yx start, Layout layout, Arena *arena){
+	bool own_arena = (arena == NULL);
+	if(own_arena) arena = new_arena(0);
+	Board *b = (Board *) arena_alloc(arena, sizeof(Board));
 	b->h = h;
 	b->w = w;
 	b->start = start;
 	b->end = b->start;
-	b->cells = (Cell **) calloc(h, sizeof(Cell *));
-	int i, j;
-	for(i=0; i<h; i++){
-		b->cells[i] = (Cell *) calloc(w, sizeof(Cell));
-		for(j=0; j<w; j++){
-			b->cells[i][j] = new_cell(true, true);
-		}
-	}
+	b->arena = arena;
+	b->own_arena = own_arena;
+	b->map = NULL;
+	b->map_size = 0;
+	b->map_path = NULL;
+	set_layout(b, layout);
+	//Every wall is up
+	b->walls = (uint64_t *) arena_alloc(arena, 2*b->nb_words*sizeof(uint64_t));
+	memset(b->walls, 0xff, 2*b->nb_words*sizeof(uint64_t));
 	return b;
 }
 
-///\brief Board destructor
+///\brief Sets Board::layout and the size of the wall planes it needs
+void set_layout(Board *b, Layout layout){
+	b->layout = layout;
+	b->tiles_w = (b->w+7)/8;
+	if(layout == TILED){
+		b->nb_words = (size_t) ((b->h+7)/8) * b->tiles_w;
+	}else{
+		b->nb_words = ((size_t) b->h*b->w + 63)/64;
+	}
+	return;
+}
+
+///\brief Board destructor. A shared arena keeps the memory until it is reset.
 void free_board(Board *b){
-	int i;
-	for(i=0; i<b->h; i++){
-		free(b->cells[i]);
+	if(b->map != NULL){
+		munmap(b->map, b->map_size);
+	}
+	if(b->own_arena){
+		free_arena(b->arena);
 	}
-	free(b->cells);
-	free(b);
 	return;
 }
 
@@ -75,18 +100,78 @@ Yx get_neigh(Board *b, Yx c, Direction dir){
 	return c;
 }
 
-///\brief Player constructor
-Player *new_player(Yx start_c, bool start_robot){
-	Player *plr = (Player*) malloc(sizeof(Player));
+///\brief Spreads the three low bits of v to bits 0, 2 and 4
+static unsigned int spread3(unsigned int v){
+	return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+}
+
+///\brief Position of cell (y, x) in the wall planes, according to Board::layout
+size_t cell_index(Board *b, int y, int x){
+	if(b->layout == TILED){
+		return ((size_t) (y >> 3) * b->tiles_w + (x >> 3)) * 64 + (spread3(y & 7) << 1 | spread3(x & 7));
+	}
+	return (size_t) y*b->w + x;
+}
+
+///\brief Gathers bits 0, 2 and 4 of v into its three low bits
+static unsigned int gather3(unsigned int v){
+	return (v & 1) | ((v >> 1) & 2) | ((v >> 2) & 4);
+}
+
+///\brief Cell at a given position in the wall planes: the inverse of cell_index()
+Yx cell_coords(Board *b, size_t i){
+	if(b->layout == TILED){
+		size_t tile = i/64;
+		unsigned int m = i%64;
+		return new_yx((tile / b->tiles_w)*8 + gather3(m >> 1), (tile % b->tiles_w)*8 + gather3(m));
+	}
+	return new_yx(i / b->w, i % b->w);
+}
+
+///\brief Reads the wall on top of (y, x), or on its left if left is true
+static bool read_wall(Board *b, int y, int x, bool left){
+	size_t i = cell_index(b, y, x);
+	return (b->walls[2*(i/64) + left] >> (i%64)) & 1;
+}
+
+///\brief Writes the wall on top of (y, x), or on its left if left is true
+static void write_wall(Board *b, int y, int x, bool left, bool val){
+	size_t i = cell_index(b, y, x);
+	uint64_t bit = (uint64_t) 1 << (i%64);
+	if(val){
+		b->walls[2*(i/64) + left] |= bit;
+	}else{
+		b->walls[2*(i/64) + left] &= ~bit;
+	}
+	return;
+}
+
+///\brief Gets both walls stored with a cell, whatever the layout
+Cell get_cell(Board *b, Yx c){
+	return new_cell(read_wall(b, c.y, c.x, false), read_wall(b, c.y, c.x, true));
+}
+
+///\brief Sets both walls stored with a cell, whatever the layout
+void set_cell(Board *b, Yx c, Cell cell){
+	write_wall(b, c.y, c.x, false, cell.top);
+	write_wall(b, c.y, c.x, true, cell.left);
+	return;
+}
+
+///\brief Player constructor. arena may be NULL to allocate on the heap.
+Player *new_player(Yx start_c, bool start_robot, Arena *arena){
+	Player *plr = (Player*) ((arena != NULL) ? arena_alloc(arena, sizeof(Player)) : malloc(sizeof(Player)));
+	plr->arena = arena;
 	plr->c = start_c;
 	plr->nb_steps = 0;
 	plr->robot = start_robot;
+	plr->log = NULL;
 	return plr;
 }
 
 ///\brief Player destructor
 void free_player(Player *plr){
-	free(plr);
+	if(plr->arena == NULL) free(plr);
 	return;
 }
 
@@ -97,13 +182,13 @@ void set_wall(Board *b, Yx c, Direction side, bool val){
 
 	//Correct input
 	if(side == LEFT){
-		b->cells[c.y][c.x].left = val;
+		write_wall(b, c.y, c.x, true, val);
 	}else if(side == DOWN){
-		b->cells[(c.y+1)%b->h][c.x].top = val;
+		write_wall(b, (c.y+1)%b->h, c.x, false, val);
 	}else if(side == UP){
-		b->cells[c.y][c.x].top = val;
+		write_wall(b, c.y, c.x, false, val);
 	}else if(side == RIGHT){
-		b->cells[c.y][(c.x+1)%b->w].left = val;
+		write_wall(b, c.y, (c.x+1)%b->w, true, val);
 	}
 
 	return;
@@ -117,13 +202,13 @@ bool get_wall(Board *b, Yx c, Direction side){
 	//Correct input
 	bool ret;
 	if(side == LEFT){
-		ret = b->cells[c.y][c.x].left;
+		ret = read_wall(b, c.y, c.x, true);
 	}else if(side == DOWN){
-		ret = b->cells[(c.y+1)%b->h][c.x].top;
+		ret = read_wall(b, (c.y+1)%b->h, c.x, false);
 	}else if(side == UP){
-		ret = b->cells[c.y][c.x].top;
+		ret = read_wall(b, c.y, c.x, false);
 	}else if(side == RIGHT){
-		ret = b->cells[c.y][(c.x+1)%b->w].left;
+		ret = read_wall(b, c.y, (c.x+1)%b->w, true);
 	}else{
 		ret = true;
 	}
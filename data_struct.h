@@ -7,7 +7,9 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include "arena.h"
 
 ///\brief Directions in which the Player can move
 typedef enum{RIGHT, UP, LEFT, DOWN, ERROR} Direction;
@@ -27,26 +29,55 @@ typedef struct{
 } Yx;
 Yx new_yx(int, int);
 
+/**
+ * \brief Order in which the cells of a Board are stored
+ *
+ * With ROW_MAJOR, cell (y, x) is bit y*w+x of the wall planes: moving UP or
+ * DOWN on a wide board jumps to another cache line. With TILED, the board is
+ * cut in 8×8 tiles stored row by row, one 64-bit word per tile, and the cells
+ * of a tile follow the Morton (Z) order: the four neighbors of most cells lie
+ * in the same word.
+ */
+typedef enum{ROW_MAJOR, TILED} Layout;
+
 ///\brief Board data structure
 typedef struct{
 	int h; ///< \brief Height: total number of lines
 	int w; ///< \brief Width: total number of columns
 	Yx start; ///< \brief Where the Player will start
 	Yx end; ///< \brief Where the Player must end
-	Cell** cells; ///< \brief Array[h][w] of cells
+	Layout layout; ///< \brief How cells are mapped to the bits of Board::walls
+	int tiles_w; ///< \brief Number of tiles on a line with the TILED layout
+	size_t nb_words; ///< \brief Number of words in each wall plane
+	uint64_t *walls; ///< \brief Wall planes, interleaved word by word: Cell::top then Cell::left; use get_wall() or get_cell()
+	void *map; ///< \brief File mapping holding Board::walls, or NULL if they live in Board::arena (see mapped.h)
+	size_t map_size; ///< \brief Size of Board::map in bytes
+	char *map_path; ///< \brief Path of the file behind Board::map
+	Arena *arena; ///< \brief Where the board and the scratch memory of its generators and solvers live
+	bool own_arena; ///< \brief True if Board::arena was created for this board alone
 } Board;
-Board *new_board(const int, const int, Yx);
+Board *new_board(const int, const int, Yx, Layout, Arena *);
 void free_board(Board *);
+void set_layout(Board *, Layout);
+size_t cell_index(Board *, int, int);
+Yx cell_coords(Board *, size_t);
+Cell get_cell(Board *, Yx);
+void set_cell(Board *, Yx, Cell);
 Yx get_neigh(Board *, Yx, Direction);
 
+///\brief Record of the moves of a Player, defined in movelog.h
+typedef struct _move_log_struct MoveLog;
+
 ///\brief Player data structure
 typedef struct{
 	Yx c; ///< \brief Coordinates
 	int nb_steps; ///< \brief Number of steps already taken
 	char str[2]; ///< \brief Characters to be printed
 	bool robot; ///< \brief If the player is not human
+	MoveLog *log; ///< \brief Where to record the moves, or NULL
+	Arena *arena; ///< \brief Arena the player lives in, or NULL if on the heap
 } Player;
-Player *new_player(Yx, bool);
+Player *new_player(Yx, bool, Arena *);
 void free_player(Player *);
 
 void set_wall(Board *, Yx, Direction, bool);
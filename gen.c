@@ -1,4 +1,136 @@
 #include "gen.h"
+#include "solve.h"
+
+///\brief Random generator state of the calling thread
+static _Thread_local struct random_data rand_data;
+///\brief Storage for ::rand_data
+static _Thread_local char rand_state[128];
+///\brief Whether ::rand_data has been initialized in the calling thread
+static _Thread_local bool rand_ready = false;
+
+/**
+ * \brief Seeds the random generator of the calling thread
+ *
+ * The generators draw from a per-thread state so that several mazes can be
+ * built at once (see ltld.c). It is the same generator as `rand()`, so a
+ * given seed gives the same maze as it always did.
+ */
+void gen_srand(unsigned int seed){
+	if(!rand_ready){
+		initstate_r(seed, rand_state, sizeof(rand_state), &rand_data);
+		rand_ready = true;
+	}
+	srandom_r(seed, &rand_data);
+	return;
+}
+
+///\brief Draws a random number from the state of the calling thread
+int gen_rand(){
+	int32_t ret;
+	if(!rand_ready){
+		gen_srand(1);
+	}
+	random_r(&rand_data, &ret);
+	return ret;
+}
+
+/**
+ * \brief Builds the maze identified by a seed, a size and an algorithm
+ *
+ * \param *ui A user interface on which to display the constructing board
+ * \param disp_lag interval in milliseconds for the display
+ * \param seed random seed
+ * \param h board height
+ * \param w board width
+ * \param alg choice of algorithm
+ * \param layout how the board stores its cells; it does not change the maze
+ * \param *end_dist where to store the minimal distance from Board::start to Board::end
+ * \param *arena where to allocate the board, or NULL (see new_board())
+ * \return the new board
+ */
+Board *new_maze(UI *ui, float disp_lag, int seed, int h, int w, GenAlgo alg, Layout layout, int *end_dist, Arena *arena){
+	gen_srand(seed);
+	Yx start = new_yx(gen_rand()%h, gen_rand()%w);
+	Board *b = new_board(h, w, start, layout, arena);
+	*end_dist = gen_maze(ui, disp_lag, b, alg);
+	return b;
+}
+
+/**
+ * \brief Builds the same maze as new_maze() with BRUTE, in a file mapped in memory
+ *
+ * Only brute_gen() keeps its memory out of the Arena: simul_gen() needs an
+ * array of distances as large as the board, in memory.
+ *
+ * \param *path the file (see map_board())
+ * \param seed random seed
+ * \param h board height
+ * \param w board width
+ * \param layout how the board stores its cells
+ * \param *end_dist where to store the minimal distance from Board::start to Board::end, which may exceed INT_MAX
+ * \return the new board, or NULL if the file cannot be mapped
+ */
+Board *new_mapped_maze(const char *path, int seed, int h, int w, Layout layout, long long *end_dist){
+	gen_srand(seed);
+	Yx start = new_yx(gen_rand()%h, gen_rand()%w);
+	Board *b = map_board(path, h, w, start, layout);
+	if(b == NULL) return NULL;
+	advise_board(b, ACCESS_LOCAL);
+	*end_dist = 0;
+	brute_gen(NULL, 0, b, b->start, &(b->end), end_dist);
+	return b;
+}
+
+/**
+ * \brief Links the cells simul_gen() left alone to the rest of the maze
+ *
+ * The second phase of simul_gen() walks a diagonal of the torus. When the
+ * height and the width have a common divisor, that diagonal does not go
+ * through every cell, and the cells it misses stay out of the maze. Each of
+ * them, in row-major order, gets a passage to its first neighbor (RIGHT to
+ * DOWN) already in the maze, then simul_gen() grows from it, as in its second
+ * phase. The passes go on until no cell is linked; then every cell is in the
+ * maze, except on a 1×1 board. When the diagonal reached every cell, this does
+ * nothing and the maze is unchanged.
+ *
+ * \param *ui A user interface on which to display the constructing board
+ * \param disp_lag interval in milliseconds for the display
+ * \param *b the board
+ * \param *end_cell the farthest found cell, updated
+ * \param *end_dist the distance to end_cell, updated
+ * \param **distances the array of simul_gen()
+ */
+static void link_alone_cells(UI *ui, float disp_lag, Board *b, Yx *end_cell, int *end_dist, int **distances){
+	bool linked = true;
+	Direction dir;
+	Yx c, n, far;
+	int dist;
+	while(linked){
+		linked = false;
+		for(c.y=0; c.y<b->h; c.y++){
+			for(c.x=0; c.x<b->w; c.x++){
+				if(!is_alone(b, c)) continue;
+				for(dir=RIGHT; dir<ERROR; dir++){
+					n = get_neigh(b, c, dir);
+					if(!is_alone(b, n)){
+						set_wall(b, c, dir, false);
+						dist = 1+distances[n.y][n.x];
+						distances[c.y][c.x] = dist;
+						far = c;
+						simul_gen(ui, disp_lag, b, c, &far, &dist, distances);
+						if(dist > *end_dist){
+							*end_dist = dist;
+							*end_cell = far;
+						}
+						linked = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return;
+}
 
 /**
  * \brief Generates a maze with given algorithm
@@ -7,30 +139,33 @@
  * \param disp_lag interval in milliseconds for the display
  * \param *b the board to set
  * \param alg choice of algorithm
- * \return the minimal distance from Board::start to Board::end
+ * \return the minimal distance from Board::start to Board::end; boards of more
+ * than INT_MAX cells need new_mapped_maze()
  */
 int gen_maze(UI *ui, float disp_lag, Board *b, GenAlgo alg){
 	int end_dist = 0;
-	int **distances = (int **) calloc(b->h, sizeof(int *));
+	long long brute_dist = 0;
+	size_t mark = arena_mark(b->arena);
+	int **distances;
 	int i, j;
 	switch(alg){
 	case BRUTE:
-		brute_gen(ui, disp_lag, b, b->start, &(b->end), &end_dist);
+		brute_gen(ui, disp_lag, b, b->start, &(b->end), &brute_dist);
+		end_dist = (int) brute_dist;
 		break;
 	case SIMUL:
+		distances = (int **) arena_alloc(b->arena, b->h*sizeof(int *));
 		for(i=0; i<b->h; i++){
-			distances[i] = (int *) calloc(b->w, sizeof(int));
+			distances[i] = (int *) arena_alloc(b->arena, b->w*sizeof(int));
 			for(j=0; j<b->w; j++){
 				distances[i][j] = 0;
 			}
 		}
 		simul_gen(ui, disp_lag, b, b->start, &(b->end), &end_dist, distances);
-		for(i=0; i<b->h; i++){
-			free(distances[i]);
-		}
-		free(distances);
+		link_alone_cells(ui, disp_lag, b, &(b->end), &end_dist, distances);
 		break;
 	}
+	arena_release(b->arena, mark);
 	return end_dist;
 }
 
@@ -42,45 +177,73 @@ int gen_maze(UI *ui, float disp_lag, Board *b, GenAlgo alg){
  * \param *b Pointer to the Board
  * \param c Cell from which to go
  * \param *end_cell Coordinates for Board::end. The farthest cell from start.
- * \param *end_dist distance to the current end; will be maximized
+ * \param *end_dist distance to the current end; will be maximized. It is
+ * 64-bit, like the depth of the path, as a board can have more than INT_MAX
+ * cells.
  *
- * Recursively looks up every yet unobserved direction.
- * Because the direction are looked up recursively one after the other, there
- * are relatively few dead ends and those are short and easy to recognize.
+ * Looks up every yet unobserved direction, depth first.
+ * Because the direction are looked up one after the other, there are
+ * relatively few dead ends and those are short and easy to recognize.
  * But the code is short and it ensures that no cell is left alone and that
  * there is no loop.
+ *
+ * The path can be as long as the board, so it is kept in an explicit stack
+ * rather than in recursive calls: one byte per step, holding the directions
+ * already tested and the one being explored. For a mapped board, the stack is
+ * mapped too (see map_scratch()). A cell is found back from the
+ * next one by going the opposite way. The farthest cell is the first one
+ * reached at the greatest depth.
  */
-void brute_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_dist){
+void brute_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, long long *end_dist){
+	size_t mark = arena_mark(b->arena);
+	size_t size = (size_t) b->h*b->w;
+	unsigned char *stack = (unsigned char *) ((b->map != NULL) ? map_scratch(b, size) : arena_alloc(b->arena, size));
+	size_t depth = 0;
+	Yx max_cell = c;
+	long long max_dist = *end_dist;
+	unsigned char tested;
+	Direction dir;
+	Yx n;
+
 	//Print WIP board
 	if(disp_lag > 0){
 		print_board(ui, b);
 		msleep(disp_lag);
 	}
-
-	//Farthest cells in every direction
-	Yx max_cell = c;
-	Yx test_cell = max_cell;
-	int max_dist = *end_dist;
-	int test_dist = max_dist;
-
-	//Test every direction in random order
-	bool tested[4] = {false, false, false, false};
-	Direction dir = rand()%4;
-	while(!tested[LEFT] || !tested[DOWN] || !tested[UP] || !tested[RIGHT]){
-		if(!tested[dir] && exists(b, get_neigh(b, c, dir)) && is_alone(b, get_neigh(b, c, dir))){
-			set_wall(b, c, dir, false);
-			test_dist++;
-			brute_gen(ui, disp_lag, b, get_neigh(b, c, dir), &test_cell, &test_dist);
-			if(test_dist > max_dist){
-				max_dist = test_dist;
-				max_cell = test_cell;
+	stack[0] = (gen_rand()%4) << 4;
+	for(;;){
+		tested = stack[depth] & 0xf;
+		dir = stack[depth] >> 4;
+		if(tested == 0xf){
+			//Every direction tested: back to the previous cell
+			if(depth == 0) break;
+			depth--;
+			c = get_neigh(b, c, opposite_dir(stack[depth] >> 4));
+			tested = stack[depth] & 0xf;
+			dir = stack[depth] >> 4;
+		}else{
+			n = get_neigh(b, c, dir);
+			if(!(tested & (1 << dir)) && exists(b, n) && is_alone(b, n)){
+				set_wall(b, c, dir, false);
+				c = n;
+				depth++;
+				if(*end_dist + (long long) depth > max_dist){
+					max_dist = *end_dist + (long long) depth;
+					max_cell = c;
+				}
+				if(disp_lag > 0){
+					print_board(ui, b);
+					msleep(disp_lag);
+				}
+				stack[depth] = (gen_rand()%4) << 4;
+				continue;
 			}
 		}
-		test_cell = c;
-		test_dist = *end_dist;
-		tested[dir] = true;
-		dir = rand()%4;
+		tested |= 1 << dir;
+		stack[depth] = tested | (gen_rand()%4) << 4;
 	}
+	if(b->map != NULL) unmap_scratch(stack, size);
+	arena_release(b->arena, mark);
 	*end_cell = max_cell;
 	*end_dist = max_dist;
 	return;
@@ -106,7 +269,8 @@ void brute_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
  * 
  * In the second phase, this algorithm is launched again to fill the blanks and
  * link them with the paths generated before. The end cell is also updated
- * during this phase.
+ * during this phase. It walks a diagonal of the torus, which misses cells when
+ * the height and the width have a common divisor: gen_maze() links those.
  * 
  * In the end, the strength of this algorithm resides in the fact that dead ends
  * are often very long and difficult to recognize at first glimpse.
@@ -121,8 +285,12 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 		struct _simul_gen_robot_struct *next;
 	} Robot;
 	
+	//Robots live in the arena; deleted ones are recycled
+	size_t mark = arena_mark(b->arena);
+	Robot *spare = NULL;
+
 	//The first robot
-	Robot *first = (Robot *) malloc(sizeof(Robot));
+	Robot *first = (Robot *) arena_alloc(b->arena, sizeof(Robot));
 	first->c = c;
 	first->dist = *end_dist;
 	first->energy = 42;
@@ -142,7 +310,7 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 	Direction dir;
 	
 	//Loop on robot
-	Robot *cur = (Robot *) malloc(sizeof(Robot));
+	Robot *cur = (Robot *) arena_alloc(b->arena, sizeof(Robot));
 	cur->next = first;
 	while(nb_robots > 0){
 		//Print WIP board
@@ -156,12 +324,17 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 		tested[UP]    = false;
 		tested[LEFT]  = false;
 		tested[DOWN]  = false;
-		dir = rand()%4;
+		dir = gen_rand()%4;
 		while((cur->next->energy > 0) && (!tested[RIGHT] || !tested[UP] || !tested[LEFT] || !tested[DOWN])){
 			if(!tested[dir] && is_alone(b, get_neigh(b, cur->next->c, dir)) && (nb_robots<=MAX_ROBOTS)){
 				//Add a new robot in next pos and crush one wall
 				set_wall(b, cur->next->c, dir, false);
-				Robot *tmp = (Robot *) malloc(sizeof(Robot));
+				Robot *tmp = spare;
+				if(tmp != NULL){
+					spare = spare->next;
+				}else{
+					tmp = (Robot *) arena_alloc(b->arena, sizeof(Robot));
+				}
 				tmp->c = get_neigh(b, cur->next->c, dir);
 				tmp->dist = cur->next->dist+1;
 				tmp->energy = --cur->next->energy;
@@ -177,16 +350,17 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 				nb_robots++;
 			}
 			tested[dir] = true;
-			dir = rand()%4;
+			dir = gen_rand()%4;
 		}
 
 		//Delete current robot
 		nb_robots--;
 		Robot *tmp = cur->next;
 		cur->next = cur->next->next;
-		free(tmp);
+		tmp->next = spare;
+		spare = tmp;
 	}
-	free(cur);
+	arena_release(b->arena, mark);
 
 	//Second phase: join alone cells
 	Yx p2_start = max_cell;
@@ -194,10 +368,22 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 	Direction p2_dir;
 	int p2_dist;
 	bool p2_linked;
-	while((p2_cur.y != p2_start.y) || (p2_cur.x != p2_start.x)){
+	//The recursive call moves p2_cur, which may then loop on a diagonal that
+	//misses p2_start: stop after a whole diagonal cycle without linking. The
+	//cells this walk never reaches are linked by gen_maze().
+	int p2_gcd = b->h, p2_rem = b->w, p2_tmp;
+	while(p2_rem != 0){
+		p2_tmp = p2_gcd%p2_rem;
+		p2_gcd = p2_rem;
+		p2_rem = p2_tmp;
+	}
+	int p2_cycle = (b->h/p2_gcd)*b->w;
+	int p2_idle = 0;
+	while(((p2_cur.y != p2_start.y) || (p2_cur.x != p2_start.x)) && (p2_idle++ <= p2_cycle)){
 		p2_cur.y = (p2_cur.y+1)%b->h;
 		p2_cur.x = (p2_cur.x+1)%b->w;
 		if(is_alone(b, p2_cur) && has_not_alone_neighbor(b, p2_cur)){
+			p2_idle = 0;
 			p2_linked = false;
 			p2_dir = RIGHT;
 			while(!p2_linked && (p2_dir < ERROR)){
@@ -222,3 +408,276 @@ void simul_gen(UI *ui, float disp_lag, Board *b, Yx c, Yx *end_cell, int *end_di
 	return;
 }
 
+
+///\brief Whether a cell lies in the region of regen_region()
+static bool in_region(Yx corner, int rh, int rw, Yx c){
+	return (c.y >= corner.y) && (c.y < corner.y+rh) && (c.x >= corner.x) && (c.x < corner.x+rw);
+}
+
+///\brief Index in the region of regen_region() of a cell inside it
+static int region_index(Yx corner, int rw, Yx c){
+	return (c.y-corner.y)*rw + (c.x-corner.x);
+}
+
+///\brief Union-find lookup, with path halving
+static int find_set(int *parent, int k){
+	while(parent[k] != k){
+		parent[k] = parent[parent[k]];
+		k = parent[k];
+	}
+	return k;
+}
+
+///\brief Appends a cell to an array that grows in the arena
+static void push_cell(Arena *arena, Yx **list, size_t *nb, size_t *cap, Yx c){
+	if(*nb == *cap){
+		Yx *bigger = (Yx *) arena_alloc(arena, 2 * *cap * sizeof(Yx));
+		memcpy(bigger, *list, *nb * sizeof(Yx));
+		*list = bigger;
+		*cap *= 2;
+	}
+	(*list)[(*nb)++] = c;
+	return;
+}
+
+/**
+ * \brief Re-carves a rectangular region of a maze, keeping it perfect
+ *
+ * \param *ui A user interface on which to display the constructing board
+ * \param disp_lag interval in milliseconds for the display
+ * \param *b the board to change
+ * \param **dist distances from Board::start in this perfect maze, as set by bfs_distances(); they are repaired
+ * \param *far the farthest cell in dist, as set by bfs_distances(); it is
+ * updated. The generators do not always leave Board::end there: call
+ * bfs_distances(b, b->start, dist, &(b->end)) first to keep Board::end as far
+ * as possible.
+ * \param corner up-left cell of the region
+ * \param rh height of the region
+ * \param rw width of the region
+ * \return the distance from Board::start to far
+ *
+ * The paths inside the region form components, each one entered from the
+ * rest of the board through its cell nearest to Board::start. Every other cell
+ * of the board either does not depend on the region, or hangs from one of
+ * these components. All the walls inside the region are raised, a random
+ * spanning tree of the region is carved, and only the entrance of the
+ * component nearest to Board::start is kept: every cell can still be reached
+ * in exactly one way.
+ *
+ * Distances are recomputed inside the region, then shifted in place for each
+ * subtree hanging from it whose path to Board::start changed length. Only
+ * these cells can get farther than far, which stays the cell bfs_distances()
+ * would return; the whole array is scanned only if far got nearer.
+ *
+ * The cost is therefore not bounded by the region. It is O(rh*rw) for the
+ * region, plus the size of every hanging subtree whose distances shift, which
+ * can be most of the board, plus O(h*w) for the scan when far got nearer. The
+ * distances and far come from one O(h*w) bfs_distances() before the first
+ * call; successive calls then keep them up to date.
+ */
+int regen_region(UI *ui, float disp_lag, Board *b, int **dist, Yx *far, Yx corner, int rh, int rw){
+	int far_dist = dist[far->y][far->x];
+	if(!exists(b, corner) || rh <= 0 || rw <= 0) return far_dist;
+	if(rh > b->h-corner.y) rh = b->h-corner.y;
+	if(rw > b->w-corner.x) rw = b->w-corner.x;
+
+	int n = rh*rw;
+	size_t mark = arena_mark(b->arena);
+	int *comp = (int *) arena_alloc(b->arena, n*sizeof(int));
+	Yx *tops = (Yx *) arena_alloc(b->arena, n*sizeof(Yx));
+	Direction *entrances = (Direction *) arena_alloc(b->arena, n*sizeof(Direction));
+	Yx *stack = (Yx *) arena_alloc(b->arena, n*sizeof(Yx));
+	int nb_comps = 0, root = -1;
+	int i, j, k, sp;
+	Yx c, nb, top;
+	Direction dir;
+
+	//Components of the paths inside the region, and their entrances
+	for(k=0; k<n; k++){
+		comp[k] = -1;
+	}
+	for(k=0; k<n; k++){
+		if(comp[k] >= 0) continue;
+		top = new_yx(corner.y+k/rw, corner.x+k%rw);
+		comp[k] = nb_comps;
+		sp = 0;
+		stack[sp++] = top;
+		while(sp > 0){
+			c = stack[--sp];
+			if(dist[c.y][c.x] >= 0 && (dist[top.y][top.x] < 0 || dist[c.y][c.x] < dist[top.y][top.x])){
+				top = c;
+			}
+			for(dir=RIGHT; dir<ERROR; dir++){
+				nb = get_neigh(b, c, dir);
+				if(!get_wall(b, c, dir) && in_region(corner, rh, rw, nb) && comp[region_index(corner, rw, nb)] < 0){
+					comp[region_index(corner, rw, nb)] = nb_comps;
+					stack[sp++] = nb;
+				}
+			}
+		}
+		tops[nb_comps] = top;
+		entrances[nb_comps] = ERROR;
+		for(dir=RIGHT; dir<ERROR && dist[top.y][top.x] > 0; dir++){
+			nb = get_neigh(b, top, dir);
+			if(!get_wall(b, top, dir) && !in_region(corner, rh, rw, nb) && dist[nb.y][nb.x] == dist[top.y][top.x]-1){
+				entrances[nb_comps] = dir;
+			}
+		}
+		if(dist[top.y][top.x] >= 0 && (root < 0 || dist[top.y][top.x] < dist[tops[root].y][tops[root].x])){
+			root = nb_comps;
+		}
+		nb_comps++;
+	}
+
+	//Exits: edges from the region to the cells hanging from it
+	int *exits = (int *) arena_alloc(b->arena, 8*(rh+rw)*sizeof(int));
+	int nb_exits = 0;
+	for(k=0; k<n; k++){
+		c = new_yx(corner.y+k/rw, corner.x+k%rw);
+		for(dir=RIGHT; dir<ERROR && dist[c.y][c.x] >= 0; dir++){
+			nb = get_neigh(b, c, dir);
+			if(!get_wall(b, c, dir) && !in_region(corner, rh, rw, nb) && dist[nb.y][nb.x] == dist[c.y][c.x]+1){
+				exits[nb_exits++] = 4*k+dir;
+			}
+		}
+	}
+
+	//Raise all walls inside the region and keep a single entrance
+	int *edges = (int *) arena_alloc(b->arena, 2*n*sizeof(int));
+	int nb_edges = 0;
+	for(k=0; k<n; k++){
+		c = new_yx(corner.y+k/rw, corner.x+k%rw);
+		if(in_region(corner, rh, rw, get_neigh(b, c, RIGHT))){
+			set_wall(b, c, RIGHT, true);
+			edges[nb_edges++] = 2*k;
+		}
+		if(in_region(corner, rh, rw, get_neigh(b, c, DOWN))){
+			set_wall(b, c, DOWN, true);
+			edges[nb_edges++] = 2*k+1;
+		}
+	}
+	for(i=0; i<nb_comps; i++){
+		if(i != root && entrances[i] != ERROR){
+			set_wall(b, tops[i], entrances[i], true);
+		}
+	}
+	Yx entry = (root >= 0) ? tops[root] : corner;
+	int entry_dist = (root >= 0) ? dist[entry.y][entry.x] : -1;
+	for(k=0; k<n && entry_dist<0; k++){
+		//Nothing in the region was reachable: open it to a reachable neighbor
+		entry = new_yx(corner.y+k/rw, corner.x+k%rw);
+		for(dir=RIGHT; dir<ERROR && entry_dist<0; dir++){
+			nb = get_neigh(b, entry, dir);
+			if(!in_region(corner, rh, rw, nb) && dist[nb.y][nb.x] >= 0){
+				set_wall(b, entry, dir, false);
+				entry_dist = dist[nb.y][nb.x]+1;
+			}
+		}
+	}
+
+	//Random spanning tree of the region
+	for(i=nb_edges-1; i>0; i--){
+		j = gen_rand()%(i+1);
+		k = edges[i];
+		edges[i] = edges[j];
+		edges[j] = k;
+	}
+	for(k=0; k<n; k++){
+		comp[k] = k;
+	}
+	for(i=0; i<nb_edges; i++){
+		k = edges[i]/2;
+		c = new_yx(corner.y+k/rw, corner.x+k%rw);
+		dir = (edges[i]%2) ? DOWN : RIGHT;
+		j = find_set(comp, region_index(corner, rw, get_neigh(b, c, dir)));
+		k = find_set(comp, k);
+		if(j != k){
+			comp[j] = k;
+			set_wall(b, c, dir, false);
+			if(disp_lag > 0){
+				print_board(ui, b);
+				msleep(disp_lag);
+			}
+		}
+	}
+
+	//New distances inside the region, from its entrance
+	int max_dist = -1;
+	Yx max_cell = *far;
+	for(k=0; k<n; k++){
+		c = new_yx(corner.y+k/rw, corner.x+k%rw);
+		dist[c.y][c.x] = -1;
+	}
+	if(entry_dist >= 0){
+		dist[entry.y][entry.x] = entry_dist;
+		sp = 0;
+		stack[sp++] = entry;
+		while(sp > 0){
+			c = stack[--sp];
+			if(is_farther(dist[c.y][c.x], c, max_dist, max_cell)){
+				max_dist = dist[c.y][c.x];
+				max_cell = c;
+			}
+			for(dir=RIGHT; dir<ERROR; dir++){
+				nb = get_neigh(b, c, dir);
+				if(!get_wall(b, c, dir) && in_region(corner, rh, rw, nb) && dist[nb.y][nb.x] < 0){
+					dist[nb.y][nb.x] = dist[c.y][c.x]+1;
+					stack[sp++] = nb;
+				}
+			}
+		}
+	}
+
+	//Shift the distances of the cells hanging from each exit
+	size_t nb_hanging, cap_hanging = n, p;
+	Yx *hanging = (Yx *) arena_alloc(b->arena, cap_hanging*sizeof(Yx));
+	int delta;
+	for(i=0; i<nb_exits; i++){
+		k = exits[i]/4;
+		c = new_yx(corner.y+k/rw, corner.x+k%rw);
+		nb = get_neigh(b, c, exits[i]%4);
+		delta = dist[c.y][c.x]+1 - dist[nb.y][nb.x];
+		if(delta == 0) continue;
+		nb_hanging = 0;
+		push_cell(b->arena, &hanging, &nb_hanging, &cap_hanging, nb);
+		for(p=0; p<nb_hanging; p++){
+			c = hanging[p];
+			for(dir=RIGHT; dir<ERROR; dir++){
+				nb = get_neigh(b, c, dir);
+				if(!get_wall(b, c, dir) && !in_region(corner, rh, rw, nb) && dist[nb.y][nb.x] == dist[c.y][c.x]+1){
+					push_cell(b->arena, &hanging, &nb_hanging, &cap_hanging, nb);
+				}
+			}
+		}
+		for(p=0; p<nb_hanging; p++){
+			c = hanging[p];
+			dist[c.y][c.x] += delta;
+			if(is_farther(dist[c.y][c.x], c, max_dist, max_cell)){
+				max_dist = dist[c.y][c.x];
+				max_cell = c;
+			}
+		}
+	}
+
+	//New farthest cell
+	if(dist[far->y][far->x] >= far_dist){
+		far_dist = dist[far->y][far->x];
+		if(is_farther(max_dist, max_cell, far_dist, *far)){
+			far_dist = max_dist;
+			*far = max_cell;
+		}
+	}else{
+		far_dist = -1;
+		for(i=0; i<b->h; i++){
+			for(j=0; j<b->w; j++){
+				if(dist[i][j] > far_dist){
+					far_dist = dist[i][j];
+					*far = new_yx(i, j);
+				}
+			}
+		}
+	}
+
+	arena_release(b->arena, mark);
+	return far_dist;
+}
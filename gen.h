@@ -1,3 +1,6 @@
+#ifndef _GEN_H_INCLUDED
+#define _GEN_H_INCLUDED
+
 /**
  * \file gen.h
  * \brief Maze generation algorithms
@@ -5,12 +8,19 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "data_struct.h"
+#include "mapped.h"
 #include "text_ui.h"
 
 ///\brief Possible algorithims to choose from
 typedef enum {BRUTE, SIMUL} GenAlgo;
-void brute_gen(UI *, float, Board *, Yx, Yx *, int *);
+void gen_srand(unsigned int);
+int gen_rand();
+Board *new_maze(UI *, float, int, int, int, GenAlgo, Layout, int *, Arena *);
+Board *new_mapped_maze(const char *, int, int, int, Layout, long long *);
+void brute_gen(UI *, float, Board *, Yx, Yx *, long long *);
 void simul_gen(UI *, float, Board *, Yx, Yx *, int *, int **);
 int gen_maze(UI *, float, Board *, GenAlgo);
-
+int regen_region(UI *, float, Board *, int **, Yx *, Yx, int, int);
+#endif //_GEN_H_INCLUDED
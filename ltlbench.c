@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "data_struct.h"
+#include "gen.h"
+#include "pack.h"
+#include "solve.h"
+
+/**
+ * \file ltlbench.c
+ * \brief Benchmark of the cell layouts
+ *
+ * Generates the same maze with every Layout and computes its distances with
+ * bfs_distances(). For each phase it reports the time, the throughput and,
+ * when the kernel lets a process count them, the hardware cache misses.
+ * It also checks that every layout gives the same maze and, with several
+ * threads, that par_bfs_distances() finds the same distances and the same
+ * path to the farthest cell as bfs_distances().
+ */
+
+///\brief Hardware counters read around each phase
+typedef struct{
+	int llc; ///< \brief File descriptor counting last level cache misses, or -1
+	int l1d; ///< \brief File descriptor counting L1 data cache read misses, or -1
+} Counters;
+
+///\brief Result of one phase
+typedef struct{
+	double ms; ///< \brief Wall clock time in milliseconds
+	long long llc; ///< \brief Last level cache misses, or -1 if not counted
+	long long l1d; ///< \brief L1 data cache read misses, or -1 if not counted
+} Measure;
+
+///\brief Opens one counter for the calling process; returns -1 if not allowed
+static int open_counter(unsigned int type, unsigned long long config){
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+///\brief Starts counting
+static void start_measure(Counters *cnt, struct timespec *t0){
+	if(cnt->llc >= 0){
+		ioctl(cnt->llc, PERF_EVENT_IOC_RESET, 0);
+		ioctl(cnt->llc, PERF_EVENT_IOC_ENABLE, 0);
+	}
+	if(cnt->l1d >= 0){
+		ioctl(cnt->l1d, PERF_EVENT_IOC_RESET, 0);
+		ioctl(cnt->l1d, PERF_EVENT_IOC_ENABLE, 0);
+	}
+	clock_gettime(CLOCK_MONOTONIC, t0);
+	return;
+}
+
+///\brief Reads a counter, or -1 if it is not open
+static long long read_counter(int fd){
+	long long val = -1;
+	if(fd < 0) return -1;
+	ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	if(read(fd, &val, sizeof(val)) != sizeof(val)) val = -1;
+	return val;
+}
+
+///\brief Stops counting
+static Measure stop_measure(Counters *cnt, struct timespec *t0){
+	struct timespec t1;
+	Measure m;
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	m.ms = (t1.tv_sec-t0->tv_sec)*1e3 + (t1.tv_nsec-t0->tv_nsec)/1e6;
+	m.llc = read_counter(cnt->llc);
+	m.l1d = read_counter(cnt->l1d);
+	return m;
+}
+
+///\brief Prints one line of results, with the speedup if it is positive
+static void print_measure(const char *layout, const char *phase, Measure m, double cells, double speedup){
+	printf("%-10s %-6s %10.1f %10.2f", layout, phase, m.ms, cells/(m.ms*1e3));
+	if(m.llc >= 0){
+		printf(" %14lld", m.llc);
+	}else{
+		printf(" %14s", "n/a");
+	}
+	if(m.l1d >= 0){
+		printf(" %14lld", m.l1d);
+	}else{
+		printf(" %14s", "n/a");
+	}
+	if(speedup > 0){
+		printf(" %8.2f\n", speedup);
+	}else{
+		printf("\n");
+	}
+	return;
+}
+
+/**
+ * \brief Main function of the benchmark
+ *
+ * Command-line parameters:
+ * -n/--cells N: square board of about N cells (default 10^7)
+ * -h/--height N, -w/--width N: board size, instead of -n
+ * -b/--brute, -S/--simul: generation algorithm (default brute)
+ * -s/--seed N: random seed
+ * -r/--runs N: keeps the best of N runs of each phase
+ * -j/--threads N: also runs par_bfs_distances() with 1, 2, 4… up to N threads
+ * -m/--min-cells N: cells per thread below which par_bfs_distances() does not split a level (default ::PAR_MIN_CELLS)
+ */
+int main(int argc, char *argv[]){
+	double nb_cells = 1e7;
+	int h = 0, w = 0;
+	int seed = 1;
+	int nb_runs = 1;
+	int max_threads = 0;
+	int min_cells = PAR_MIN_CELLS;
+	GenAlgo alg = BRUTE;
+	const Layout layouts[] = {ROW_MAJOR, TILED};
+	const char *names[] = {"row-major", "tiled"};
+	const int nb_layouts = 2;
+	int i, l, r;
+
+	//Read through parameters
+	for(i=1; i<argc; i++){
+		if(!strcmp(argv[i], "-b") || !strcmp(argv[i], "--brute")){
+			alg = BRUTE;
+		}else if(!strcmp(argv[i], "-S") || !strcmp(argv[i], "--simul")){
+			alg = SIMUL;
+		}else if(i+1 == argc){
+			fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}else if(!strcmp(argv[i], "-n") || !strcmp(argv[i], "--cells")){
+			nb_cells = strtod(argv[++i], NULL);
+		}else if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--height")){
+			h = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-w") || !strcmp(argv[i], "--width")){
+			w = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-s") || !strcmp(argv[i], "--seed")){
+			seed = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-r") || !strcmp(argv[i], "--runs")){
+			nb_runs = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-j") || !strcmp(argv[i], "--threads")){
+			max_threads = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-m") || !strcmp(argv[i], "--min-cells")){
+			min_cells = (int) strtol(argv[++i], NULL, 10);
+		}else{
+			fprintf(stderr, "Unknown parameter: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(h <= 0) h = (int) sqrt(nb_cells);
+	if(w <= 0) w = (int) (nb_cells/h);
+	if(h < 1 || w < 1 || nb_runs < 1 || max_threads < 0 || min_cells < 0 || (double) h*w > 2147483647.0){
+		fprintf(stderr, "Invalid parameters\n");
+		return EXIT_FAILURE;
+	}
+	nb_cells = (double) h*w;
+
+	Counters cnt;
+	cnt.llc = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	cnt.l1d = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+		| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	printf("Board %d × %d = %.0f cells, %s, seed %d, best of %d\n", h, w, nb_cells, (alg == BRUTE) ? "brute" : "simul", seed, nb_runs);
+	if(cnt.llc < 0 && cnt.l1d < 0){
+		printf("Hardware counters unavailable (see /proc/sys/kernel/perf_event_paranoid)\n");
+	}
+	printf("%-10s %-6s %10s %10s %14s %14s %8s\n", "layout", "", "ms", "Mcells/s", "cache-misses", "L1d-misses", "speedup");
+
+	//Thread counts for par_bfs_distances()
+	int thread_counts[32];
+	int nb_counts = 0, t;
+	for(t=1; t<max_threads && nb_counts<31; t*=2){
+		thread_counts[nb_counts++] = t;
+	}
+	if(max_threads > 0) thread_counts[nb_counts++] = max_threads;
+	Measure best_par[32];
+	bool same_par = true;
+	char label[16];
+
+	//Every layout must give the same maze
+	unsigned long long hashes[2];
+	int end_dists[2], far_dists[2];
+	Measure m, best_gen, best_bfs;
+	struct timespec t0;
+	Arena *arena;
+	Board *b;
+	int **dist, **par_dist;
+	Yx far, par_far;
+	Direction *path, *par_path;
+	int len, par_len;
+	for(l=0; l<nb_layouts; l++){
+		for(r=0; r<nb_runs; r++){
+			arena = new_arena(0);
+			start_measure(&cnt, &t0);
+			b = new_maze(NULL, 0, seed, h, w, alg, layouts[l], &end_dists[l], arena);
+			m = stop_measure(&cnt, &t0);
+			if(r == 0 || m.ms < best_gen.ms) best_gen = m;
+			dist = new_distances(b);
+			start_measure(&cnt, &t0);
+			far_dists[l] = bfs_distances(b, b->start, dist, &far);
+			m = stop_measure(&cnt, &t0);
+			if(r == 0 || m.ms < best_bfs.ms) best_bfs = m;
+			hashes[l] = hash_board(b);
+
+			//Same distances and same path with every number of threads
+			if(nb_counts > 0){
+				par_dist = new_distances(b);
+				path = (Direction *) malloc((far_dists[l]+1)*sizeof(Direction));
+				par_path = (Direction *) malloc((far_dists[l]+1)*sizeof(Direction));
+				len = shortest_path(b, dist, far, path);
+			}
+			for(t=0; t<nb_counts; t++){
+				start_measure(&cnt, &t0);
+				par_bfs_distances(b, b->start, par_dist, &par_far, thread_counts[t], min_cells);
+				m = stop_measure(&cnt, &t0);
+				if(r == 0 || m.ms < best_par[t].ms) best_par[t] = m;
+				for(i=0; i<h && same_par; i++){
+					same_par = !memcmp(dist[i], par_dist[i], w*sizeof(int));
+				}
+				par_len = shortest_path(b, par_dist, par_far, par_path);
+				same_par = same_par && (par_far.y == far.y) && (par_far.x == far.x) && (par_len == len)
+					&& !memcmp(path, par_path, len*sizeof(Direction));
+			}
+			if(nb_counts > 0){
+				free(path);
+				free(par_path);
+			}
+			free_board(b);
+			free_arena(arena);
+		}
+		print_measure(names[l], "gen", best_gen, nb_cells, 0);
+		print_measure(names[l], "bfs", best_bfs, nb_cells, 0);
+		for(t=0; t<nb_counts; t++){
+			snprintf(label, sizeof(label), "par %d", thread_counts[t]);
+			print_measure(names[l], label, best_par[t], nb_cells, best_par[0].ms/best_par[t].ms);
+		}
+	}
+
+	bool same = true;
+	for(l=1; l<nb_layouts; l++){
+		same = same && (hashes[l] == hashes[0]) && (end_dists[l] == end_dists[0]) && (far_dists[l] == far_dists[0]);
+	}
+	printf("Maze %016llx, end at %d: %s\n", hashes[0], end_dists[0], same ? "identical in every layout" : "LAYOUTS DIFFER");
+	if(nb_counts > 0){
+		printf("Parallel distances and path: %s\n", same_par ? "same as serial" : "DIFFERENT FROM SERIAL");
+	}
+	if(cnt.llc >= 0) close(cnt.llc);
+	if(cnt.l1d >= 0) close(cnt.l1d);
+	return (same && same_par) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,671 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gen.h"
+#include "pack.h"
+#include "proto.h"
+
+/**
+ * \file ltld.c
+ * \brief Maze generation daemon
+ *
+ * Serves packed boards over a Unix domain socket (see proto.h). The main
+ * thread polls every connection and queues each request line it reads for a
+ * pool of worker threads, which take one request at a time: a client sending
+ * many requests does not hold a worker, and does not keep the others waiting.
+ * The next line of a connection is only taken once the previous one is
+ * answered, so that replies come in the order of the requests. Generated boards are kept in a
+ * least-recently-used cache bounded in bytes, and a background thread keeps a
+ * stock of ready boards for popular sizes, which are used to answer requests
+ * that let the daemon choose the seed.
+ */
+
+///\brief Default largest board the daemon agrees to generate, in cells
+#define MAX_CELLS (1 << 18)
+///\brief Stack size for threads running the recursive generators
+#define GEN_STACK_SIZE (64 << 20)
+///\brief Number of events handled per call to epoll_wait()
+#define MAX_EVENTS 64
+///\brief Number of sizes whose popularity is tracked
+#define MAX_SIZES 32
+///\brief Maximal number of ready boards kept per popular size
+#define MAX_STOCK 64
+///\brief Number of requests after which a size becomes popular
+#define POPULAR_HITS 16
+
+///\brief A cached packed board (hash chain and LRU list)
+typedef struct _cache_entry_struct{
+	Request key; ///< \brief Request answered by this board
+	unsigned char *data; ///< \brief Packed board
+	size_t len; ///< \brief Length of Entry::data
+	struct _cache_entry_struct *chain; ///< \brief Next entry in the same bucket
+	struct _cache_entry_struct *prev; ///< \brief More recently used entry
+	struct _cache_entry_struct *next; ///< \brief Less recently used entry
+} Entry;
+
+///\brief Size-bounded LRU cache of packed boards
+typedef struct{
+	Entry **buckets; ///< \brief Hash table
+	size_t nb_buckets; ///< \brief Number of buckets in Cache::buckets
+	Entry *head; ///< \brief Most recently used entry
+	Entry *tail; ///< \brief Least recently used entry
+	size_t bytes; ///< \brief Total size of the cached boards
+	size_t max_bytes; ///< \brief Bound on Cache::bytes
+	long hits; ///< \brief Number of requests answered from the cache
+	long misses; ///< \brief Number of requests that needed a generation
+	pthread_mutex_t lock; ///< \brief Protects everything above
+} Cache;
+
+///\brief Popularity and stock of ready boards for one size
+typedef struct{
+	int h; ///< \brief Board height
+	int w; ///< \brief Board width
+	GenAlgo alg; ///< \brief Generation algorithm
+	bool pinned; ///< \brief Popular from the start (command line)
+	long hits; ///< \brief Number of requests for this size
+	int nb_ready; ///< \brief Number of boards in stock
+	int seeds[MAX_STOCK]; ///< \brief Seeds of the boards in stock
+	unsigned char *data[MAX_STOCK]; ///< \brief Boards in stock
+	size_t len[MAX_STOCK]; ///< \brief Lengths of the boards in stock
+} Size;
+
+///\brief Popular sizes and their stocks
+typedef struct{
+	Size sizes[MAX_SIZES]; ///< \brief Known sizes
+	int nb_sizes; ///< \brief Number of entries in Stock::sizes
+	int target; ///< \brief Number of ready boards to keep per popular size
+	int next_seed; ///< \brief Next seed the daemon will choose
+	long served; ///< \brief Number of requests answered from the stock
+	pthread_mutex_t lock; ///< \brief Protects everything above
+	pthread_cond_t low; ///< \brief Signaled when a stock needs filling
+} Stock;
+
+/**
+ * \brief A client connection
+ *
+ * It belongs either to the main thread, which waits for it to be readable, or
+ * to the Queue, or to the worker answering its request; never to two of them.
+ */
+typedef struct _conn_struct{
+	LineReader reader; ///< \brief Socket and bytes read from it
+	char line[REQUEST_MAX_LINE]; ///< \brief Request waiting for a worker
+	struct _conn_struct *next; ///< \brief Next connection in the Queue
+} Conn;
+
+///\brief Connections with a request waiting for a worker, oldest first
+typedef struct{
+	Conn *first; ///< \brief Oldest connection
+	Conn *last; ///< \brief Newest connection
+	pthread_mutex_t lock; ///< \brief Protects everything above
+	pthread_cond_t not_empty; ///< \brief Signaled when a connection is queued
+} Queue;
+
+static Cache cache;
+static Stock stock;
+static Queue queue;
+///\brief Polls the connections waiting for a request
+static int epoll_fd;
+///\brief Largest board the daemon agrees to generate, in cells (-m)
+static long max_cells = MAX_CELLS;
+///\brief Highest arena use of a single worker, protected by Stock::lock
+static size_t arena_peak = 0;
+///\brief Set by the signal handler to stop the daemon
+static volatile sig_atomic_t quit = 0;
+
+///\brief Signal handler for SIGINT and SIGTERM
+static void on_signal(int sig){
+	quit = 1;
+	return;
+}
+
+//Cache
+///\brief Hash of a request with a fixed seed
+static size_t hash_request(const Request *key){
+	size_t hash = 2166136261u;
+	hash = (hash ^ (unsigned int) key->seed) * 16777619u;
+	hash = (hash ^ (unsigned int) key->h) * 16777619u;
+	hash = (hash ^ (unsigned int) key->w) * 16777619u;
+	hash = (hash ^ (unsigned int) key->alg) * 16777619u;
+	return hash;
+}
+
+///\brief Whether two requests ask for the same board
+static bool same_request(const Request *a, const Request *b){
+	return (a->seed == b->seed) && (a->h == b->h) && (a->w == b->w) && (a->alg == b->alg);
+}
+
+///\brief Cache constructor
+static void init_cache(size_t max_bytes){
+	cache.nb_buckets = 4096;
+	cache.buckets = (Entry **) calloc(cache.nb_buckets, sizeof(Entry *));
+	cache.head = NULL;
+	cache.tail = NULL;
+	cache.bytes = 0;
+	cache.max_bytes = max_bytes;
+	cache.hits = 0;
+	cache.misses = 0;
+	pthread_mutex_init(&cache.lock, NULL);
+	return;
+}
+
+///\brief Removes an entry from the LRU list. Needs Cache::lock.
+static void unlink_entry(Entry *e){
+	if(e->prev) e->prev->next = e->next;
+	else cache.head = e->next;
+	if(e->next) e->next->prev = e->prev;
+	else cache.tail = e->prev;
+	return;
+}
+
+///\brief Puts an entry in front of the LRU list. Needs Cache::lock.
+static void push_entry(Entry *e){
+	e->prev = NULL;
+	e->next = cache.head;
+	if(cache.head) cache.head->prev = e;
+	cache.head = e;
+	if(!cache.tail) cache.tail = e;
+	return;
+}
+
+///\brief Finds an entry. Needs Cache::lock.
+static Entry *find_entry(const Request *key){
+	Entry *e = cache.buckets[hash_request(key) % cache.nb_buckets];
+	while(e && !same_request(&(e->key), key)){
+		e = e->chain;
+	}
+	return e;
+}
+
+///\brief Evicts the least recently used entry. Needs Cache::lock.
+static void evict_entry(){
+	Entry *e = cache.tail;
+	Entry **p = &(cache.buckets[hash_request(&(e->key)) % cache.nb_buckets]);
+	while(*p != e){
+		p = &((*p)->chain);
+	}
+	*p = e->chain;
+	unlink_entry(e);
+	cache.bytes -= e->len;
+	free(e->data);
+	free(e);
+	return;
+}
+
+/**
+ * \brief Looks a board up in the cache
+ *
+ * \param *key the request, with a fixed seed
+ * \param *len where to store the length of the board
+ * \return a copy of the packed board, to be freed, or NULL on a miss
+ */
+static unsigned char *cache_get(const Request *key, size_t *len){
+	unsigned char *ret = NULL;
+	pthread_mutex_lock(&cache.lock);
+	Entry *e = find_entry(key);
+	if(e){
+		unlink_entry(e);
+		push_entry(e);
+		ret = (unsigned char *) malloc(e->len);
+		memcpy(ret, e->data, e->len);
+		*len = e->len;
+		cache.hits++;
+	}else{
+		cache.misses++;
+	}
+	pthread_mutex_unlock(&cache.lock);
+	return ret;
+}
+
+///\brief Stores a copy of a packed board in the cache
+static void cache_put(const Request *key, const unsigned char *data, size_t len){
+	if(len > cache.max_bytes) return;
+	pthread_mutex_lock(&cache.lock);
+	if(!find_entry(key)){
+		while(cache.bytes+len > cache.max_bytes){
+			evict_entry();
+		}
+		Entry *e = (Entry *) malloc(sizeof(Entry));
+		e->key = *key;
+		e->key.any_seed = false;
+		e->data = (unsigned char *) malloc(len);
+		memcpy(e->data, data, len);
+		e->len = len;
+		Entry **bucket = &(cache.buckets[hash_request(key) % cache.nb_buckets]);
+		e->chain = *bucket;
+		*bucket = e;
+		push_entry(e);
+		cache.bytes += len;
+	}
+	pthread_mutex_unlock(&cache.lock);
+	return;
+}
+
+//Generation
+/**
+ * \brief Generates a board and packs it
+ *
+ * \param *req the request, with a fixed seed
+ * \param *len where to store the length of the packed board
+ * \param *arena the arena of the calling thread, reset afterwards
+ * \return the packed board, to be freed
+ */
+static unsigned char *generate(const Request *req, size_t *len, Arena *arena){
+	int end_dist;
+	Board *b = new_maze(NULL, 0, req->seed, req->h, req->w, req->alg, ROW_MAJOR, &end_dist, arena);
+	unsigned char *data = (unsigned char *) malloc(packed_size(b->h, b->w));
+	*len = pack_board(b, end_dist, data);
+	free_board(b);
+	arena_reset(arena);
+	return data;
+}
+
+//Stock
+///\brief Whether a size deserves ready boards. Needs Stock::lock.
+static bool is_popular(const Size *s){
+	return s->pinned || (s->hits >= POPULAR_HITS);
+}
+
+///\brief Finds or adds a size. Needs Stock::lock. Returns NULL if the table is full.
+static Size *find_size(int h, int w, GenAlgo alg){
+	int i;
+	for(i=0; i<stock.nb_sizes; i++){
+		if(stock.sizes[i].h == h && stock.sizes[i].w == w && stock.sizes[i].alg == alg){
+			return &(stock.sizes[i]);
+		}
+	}
+	if(stock.nb_sizes == MAX_SIZES) return NULL;
+	Size *s = &(stock.sizes[stock.nb_sizes++]);
+	memset(s, 0, sizeof(Size));
+	s->h = h;
+	s->w = w;
+	s->alg = alg;
+	return s;
+}
+
+///\brief Stock constructor
+static void init_stock(int target){
+	stock.nb_sizes = 0;
+	stock.target = (target < MAX_STOCK) ? target : MAX_STOCK;
+	stock.next_seed = time(NULL);
+	stock.served = 0;
+	pthread_mutex_init(&stock.lock, NULL);
+	pthread_cond_init(&stock.low, NULL);
+	return;
+}
+
+///\brief Picks a seed for a request that lets the daemon choose
+static int new_seed(){
+	pthread_mutex_lock(&stock.lock);
+	int seed = stock.next_seed++;
+	pthread_mutex_unlock(&stock.lock);
+	return seed;
+}
+
+/**
+ * \brief Counts a request for a size and takes a ready board if there is one
+ *
+ * \param *req the request
+ * \param *len where to store the length of the board
+ * \return a packed board, to be freed, with its seed in Request::seed; or
+ * NULL if the stock is empty or req does not let the daemon choose the seed
+ */
+static unsigned char *stock_take(Request *req, size_t *len){
+	unsigned char *ret = NULL;
+	pthread_mutex_lock(&stock.lock);
+	Size *s = find_size(req->h, req->w, req->alg);
+	if(s){
+		s->hits++;
+		if(req->any_seed && s->nb_ready > 0){
+			s->nb_ready--;
+			ret = s->data[s->nb_ready];
+			*len = s->len[s->nb_ready];
+			req->seed = s->seeds[s->nb_ready];
+			stock.served++;
+		}
+		if(is_popular(s) && s->nb_ready < stock.target){
+			pthread_cond_signal(&stock.low);
+		}
+	}
+	pthread_mutex_unlock(&stock.lock);
+	return ret;
+}
+
+///\brief Background thread keeping the stocks of popular sizes full
+static void *pregen_thread(void *arg){
+	Request req;
+	Size *s;
+	int i;
+	unsigned char *data;
+	size_t len;
+	Arena *arena = new_arena(0);
+	while(true){
+		//Wait for a popular size to run low
+		pthread_mutex_lock(&stock.lock);
+		s = NULL;
+		while(s == NULL){
+			for(i=0; i<stock.nb_sizes && s == NULL; i++){
+				if(is_popular(&(stock.sizes[i])) && stock.sizes[i].nb_ready < stock.target){
+					s = &(stock.sizes[i]);
+				}
+			}
+			if(s == NULL) pthread_cond_wait(&stock.low, &stock.lock);
+		}
+		req.any_seed = false;
+		req.seed = stock.next_seed++;
+		req.h = s->h;
+		req.w = s->w;
+		req.alg = s->alg;
+		pthread_mutex_unlock(&stock.lock);
+
+		//Generate outside of the lock
+		data = generate(&req, &len, arena);
+		pthread_mutex_lock(&stock.lock);
+		if(arena->peak > arena_peak) arena_peak = arena->peak;
+		if(s->nb_ready < stock.target){
+			s->seeds[s->nb_ready] = req.seed;
+			s->data[s->nb_ready] = data;
+			s->len[s->nb_ready] = len;
+			s->nb_ready++;
+			data = NULL;
+		}
+		pthread_mutex_unlock(&stock.lock);
+		free(data);
+	}
+	return NULL;
+}
+
+//Workers
+///\brief Queue constructor
+static void init_queue(){
+	queue.first = NULL;
+	queue.last = NULL;
+	pthread_mutex_init(&queue.lock, NULL);
+	pthread_cond_init(&queue.not_empty, NULL);
+	return;
+}
+
+///\brief Hands the request of a connection to the workers
+static void queue_push(Conn *c){
+	c->next = NULL;
+	pthread_mutex_lock(&queue.lock);
+	if(queue.last) queue.last->next = c;
+	else queue.first = c;
+	queue.last = c;
+	pthread_cond_signal(&queue.not_empty);
+	pthread_mutex_unlock(&queue.lock);
+	return;
+}
+
+///\brief Takes a connection with a request, waiting for one if needed
+static Conn *queue_pop(){
+	pthread_mutex_lock(&queue.lock);
+	while(queue.first == NULL){
+		pthread_cond_wait(&queue.not_empty, &queue.lock);
+	}
+	Conn *c = queue.first;
+	queue.first = c->next;
+	if(queue.first == NULL) queue.last = NULL;
+	pthread_mutex_unlock(&queue.lock);
+	return c;
+}
+
+///\brief Closes a connection and frees it
+static void close_conn(Conn *c){
+	close(c->reader.fd);
+	free(c);
+	return;
+}
+
+///\brief Gives a connection back to the main thread, until it is readable again
+static void watch_conn(Conn *c){
+	struct epoll_event ev;
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.ptr = c;
+	if(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->reader.fd, &ev)){
+		close_conn(c);
+	}
+	return;
+}
+
+/**
+ * \brief Hands on a connection whose request was answered or was being read
+ *
+ * Queues its next request if one is already read, closes it at its end, or
+ * waits for more bytes.
+ *
+ * \param *c the connection
+ * \param open false if nothing more can be read from the connection
+ */
+static void next_request(Conn *c, bool open){
+	if(take_line(&(c->reader), c->line, sizeof(c->line)) >= 0){
+		queue_push(c);
+	}else if(open && !c->reader.eof){
+		watch_conn(c);
+	}else{
+		close_conn(c);
+	}
+	return;
+}
+
+///\brief Answers one request, generating in the arena of the calling thread
+static bool serve_request(int fd, const char *line, Arena *arena){
+	Request req;
+	unsigned char *data = NULL;
+	size_t len = 0;
+	if(!parse_request(line, &req)){
+		fprintf(stderr, "ltld: refused \"%s\": malformed request\n", line);
+		return send_reply(fd, 0, NULL, 0);
+	}
+	if((long) req.h*req.w > max_cells){
+		fprintf(stderr, "ltld: refused \"%s\": %ld cells, more than %ld (see -m)\n", line, (long) req.h*req.w, max_cells);
+		return send_reply(fd, 0, NULL, 0);
+	}
+	data = stock_take(&req, &len);
+	if(data){
+		cache_put(&req, data, len);
+	}else{
+		if(req.any_seed){
+			req.seed = new_seed();
+			req.any_seed = false;
+		}else{
+			data = cache_get(&req, &len);
+		}
+		if(!data){
+			data = generate(&req, &len, arena);
+			cache_put(&req, data, len);
+		}
+	}
+	bool ret = send_reply(fd, req.seed, data, len);
+	free(data);
+	return ret;
+}
+
+///\brief Worker thread: answers queued requests, one at a time
+static void *worker_thread(void *arg){
+	Conn *c;
+	Arena *arena = new_arena(0);
+	while(true){
+		c = queue_pop();
+		if(serve_request(c->reader.fd, c->line, arena)){
+			next_request(c, true);
+		}else{
+			close_conn(c);
+		}
+		pthread_mutex_lock(&stock.lock);
+		if(arena->peak > arena_peak) arena_peak = arena->peak;
+		pthread_mutex_unlock(&stock.lock);
+	}
+	return NULL;
+}
+
+///\brief Starts a detached thread with a stack large enough for the generators
+static void start_thread(void *(*run)(void *)){
+	pthread_t thread;
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, GEN_STACK_SIZE);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if(pthread_create(&thread, &attr, run, NULL)){
+		perror("pthread_create");
+		exit(EXIT_FAILURE);
+	}
+	pthread_attr_destroy(&attr);
+	return;
+}
+
+/**
+ * \brief Main function of the daemon
+ *
+ * Command-line parameters:
+ * -s/--socket PATH: listens on PATH instead of ::LTLD_SOCKET
+ * -j/--jobs N: runs N worker threads
+ * -c/--cache N: bounds the cache to N MiB
+ * -p/--popular HxW[b|s]: keeps ready boards of that size from the start
+ * -k/--stock N: keeps N ready boards per popular size
+ * -m/--max-cells N: refuses boards of more than N cells (default ::MAX_CELLS)
+ *
+ * Refused requests are logged on the standard error.
+ */
+int main(int argc, char *argv[]){
+	const char *path = LTLD_SOCKET;
+	int nb_workers = 4;
+	long cache_mb = 64;
+	int target = 8;
+	int h, w;
+	char alg;
+	int i;
+	Size *s;
+
+	//Read through parameters
+	init_stock(target);
+	for(i=1; i<argc; i++){
+		if(i+1 == argc){
+			fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+		if(!strcmp(argv[i], "-s") || !strcmp(argv[i], "--socket")){
+			path = argv[++i];
+		}else if(!strcmp(argv[i], "-j") || !strcmp(argv[i], "--jobs")){
+			nb_workers = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-c") || !strcmp(argv[i], "--cache")){
+			cache_mb = strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-k") || !strcmp(argv[i], "--stock")){
+			target = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-m") || !strcmp(argv[i], "--max-cells")){
+			max_cells = strtol(argv[++i], NULL, 10);
+			if(max_cells < 1 || max_cells > 2147483647L){
+				fprintf(stderr, "Invalid number of cells: %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+		}else if(!strcmp(argv[i], "-p") || !strcmp(argv[i], "--popular")){
+			alg = 's';
+			if(sscanf(argv[++i], "%dx%d%c", &h, &w, &alg) < 2 || h <= 0 || w <= 0){
+				fprintf(stderr, "Invalid size: %s\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+			s = find_size(h, w, (alg == 'b') ? BRUTE : SIMUL);
+			if(s) s->pinned = true;
+		}else{
+			fprintf(stderr, "Unknown parameter: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	for(i=0; i<stock.nb_sizes; i++){
+		s = &(stock.sizes[i]);
+		if((long) s->h*s->w > max_cells){
+			fprintf(stderr, "Invalid size: %dx%d is more than %ld cells (see -m)\n", s->h, s->w, max_cells);
+			return EXIT_FAILURE;
+		}
+	}
+	if(nb_workers < 1) nb_workers = 1;
+	stock.target = (target < 0) ? 0 : (target < MAX_STOCK) ? target : MAX_STOCK;
+	init_cache((size_t) cache_mb << 20);
+	init_queue();
+
+	//Socket
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(path) >= sizeof(addr.sun_path)){
+		fprintf(stderr, "Socket path too long: %s\n", path);
+		return EXIT_FAILURE;
+	}
+	strcpy(addr.sun_path, path);
+	int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(path);
+	if(listen_fd < 0 || bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) || listen(listen_fd, 128)){
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	//Signals: no SA_RESTART, so that epoll_wait() returns when asked to quit
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	//Threads
+	for(i=0; i<nb_workers; i++){
+		start_thread(worker_thread);
+	}
+	start_thread(pregen_thread);
+	pthread_mutex_lock(&stock.lock);
+	pthread_cond_signal(&stock.low);
+	pthread_mutex_unlock(&stock.lock);
+	printf("ltld: listening on %s with %d workers\n", path, nb_workers);
+	fflush(stdout);
+
+	//Main loop: accept connections and read their requests
+	struct epoll_event ev, events[MAX_EVENTS];
+	int nb_events, fd;
+	Conn *c;
+	epoll_fd = epoll_create1(0);
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if(epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev)){
+		perror("epoll");
+		return EXIT_FAILURE;
+	}
+	while(!quit){
+		nb_events = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+		if(nb_events < 0 && errno != EINTR){
+			perror("epoll_wait");
+		}
+		for(i=0; i<nb_events; i++){
+			c = (Conn *) events[i].data.ptr;
+			if(c){
+				next_request(c, fill_reader(&(c->reader)));
+				continue;
+			}
+			fd = accept(listen_fd, NULL, NULL);
+			if(fd < 0){
+				if(errno != EINTR) perror("accept");
+				continue;
+			}
+			c = (Conn *) malloc(sizeof(Conn));
+			init_reader(&(c->reader), fd);
+			ev.events = EPOLLIN | EPOLLONESHOT;
+			ev.data.ptr = c;
+			if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev)){
+				perror("epoll_ctl");
+				close_conn(c);
+			}
+		}
+	}
+	close(listen_fd);
+	unlink(path);
+	pthread_mutex_lock(&cache.lock);
+	pthread_mutex_lock(&stock.lock);
+	printf("ltld: %ld cache hits, %ld misses, %ld from stock, %zu bytes cached\n", cache.hits, cache.misses, stock.served, cache.bytes);
+	printf("ltld: arena peak of a single thread: %zu bytes\n", arena_peak);
+	return EXIT_SUCCESS;
+}
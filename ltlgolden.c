@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "data_struct.h"
+#include "gen.h"
+#include "pack.h"
+#include "solve.h"
+
+/**
+ * \file ltlgolden.c
+ * \brief Regression test of the generators, for output and speed
+ *
+ * Builds the maze of every case of a fixed matrix of seeds, sizes and
+ * algorithms, hashes its walls, and compares the hash, Board::end and the
+ * distance to it with a golden file. In the same run, the best time of a few
+ * generations is compared with the golden time: a case fails if it got
+ * slower than the threshold allows.
+ *
+ * Outputs and times are kept in two files. The outputs do not depend on the
+ * machine: `--update` writes them from the current code, once a change of
+ * output is intended; they are kept in git. The times do: they are not kept
+ * in git, `--update-times` writes them on the machine the check runs on, and
+ * refuses if any output differs from the golden one, so that it cannot hide a
+ * change of output. Without a times file recorded on this host, only the
+ * outputs are checked.
+ *
+ * The golden file has one line per case: seed, height, width, algorithm
+ * (`b` or `s`), hash, end line, end column and distance to the end. The times
+ * file starts with `# host NAME`, then has the seed, height, width, algorithm
+ * and time in milliseconds. Other lines starting with `#` are comments.
+ *
+ * The check also re-carves random regions of a few mazes with regen_region(),
+ * and compares the distances and the farthest cell it repairs with a fresh
+ * bfs_distances(). This needs no golden file.
+ */
+
+///\brief Default golden file, relative to the directory of the Makefile
+#define GOLDEN_FILE "golden.txt"
+///\brief Default golden times file, relative to the directory of the Makefile
+#define GOLDEN_TIMES_FILE "golden_times.txt"
+///\brief Slowdown under which a case never fails, whatever the threshold, in milliseconds
+#define GOLDEN_SLACK_MS 2.0
+
+///\brief One case of the matrix, with its results
+typedef struct{
+	int seed; ///< \brief Random seed
+	int h; ///< \brief Board height
+	int w; ///< \brief Board width
+	GenAlgo alg; ///< \brief Generation algorithm
+	unsigned long long hash; ///< \brief Hash of the walls
+	Yx end; ///< \brief Board::end
+	int end_dist; ///< \brief Distance from Board::start to Board::end
+	double ms; ///< \brief Best generation time in milliseconds, or -1 if unknown
+} Case;
+
+///\brief Seeds of the matrix
+static const int SEEDS[] = {1, 2, 42, 1000, 123456789};
+///\brief Sizes of the matrix for brute_gen()
+static const int BRUTE_SIZES[][2] = {{1, 1}, {1, 9}, {9, 1}, {20, 41}, {50, 51}, {100, 100}, {300, 700}, {640, 640}};
+///\brief Sizes of the matrix for simul_gen(), whose second phase grows with the square of the size
+static const int SIMUL_SIZES[][2] = {{1, 1}, {1, 9}, {9, 1}, {10, 10}, {20, 41}, {50, 51}, {31, 53}, {61, 97}};
+///\brief Seeds of the regen_region() check
+static const int REGEN_SEEDS[] = {1, 2, 26};
+///\brief Sizes of the regen_region() check
+static const int REGEN_SIZES[][2] = {{1, 9}, {9, 1}, {10, 10}, {20, 41}, {31, 53}};
+///\brief Regions re-carved per maze by the regen_region() check; every fifth one is the whole board
+#define REGEN_ROUNDS 20
+
+///\brief Letter of an algorithm in the golden file
+static char alg_letter(GenAlgo alg){
+	return (alg == BRUTE) ? 'b' : 's';
+}
+
+/**
+ * \brief Builds the maze of a case and fills its results
+ *
+ * \param *c the case
+ * \param nb_runs number of generations, the best time is kept
+ * \param *arena memory for the boards; reset after each of them
+ * \return false if the other layout gives another maze
+ */
+static bool run_case(Case *c, int nb_runs, Arena *arena){
+	struct timespec t0, t1;
+	double ms;
+	int r, end_dist;
+	Board *b;
+	for(r=0; r<nb_runs; r++){
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		b = new_maze(NULL, 0, c->seed, c->h, c->w, c->alg, ROW_MAJOR, &(c->end_dist), arena);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		ms = (t1.tv_sec-t0.tv_sec)*1e3 + (t1.tv_nsec-t0.tv_nsec)/1e6;
+		if(r == 0 || ms < c->ms) c->ms = ms;
+		c->hash = hash_board(b);
+		c->end = b->end;
+		free_board(b);
+		arena_reset(arena);
+	}
+	b = new_maze(NULL, 0, c->seed, c->h, c->w, c->alg, TILED, &end_dist, arena);
+	bool same = (hash_board(b) == c->hash) && (b->end.y == c->end.y) && (b->end.x == c->end.x) && (end_dist == c->end_dist);
+	free_board(b);
+	arena_reset(arena);
+	return same;
+}
+
+/**
+ * \brief Whether regen_region() left a perfect maze with the right distances
+ *
+ * \param *b the board
+ * \param **dist the distances repaired by regen_region()
+ * \param far_dist what regen_region() returned, for Board::end
+ */
+static bool regen_ok(Board *b, int **dist, int far_dist){
+	size_t mark = arena_mark(b->arena);
+	int **fresh = new_distances(b);
+	Yx far;
+	int fresh_dist = bfs_distances(b, b->start, fresh, &far);
+	bool ok = (fresh_dist == far_dist) && (far.y == b->end.y) && (far.x == b->end.x);
+	int i;
+	for(i=0; i<b->h && ok; i++){
+		ok = !memcmp(fresh[i], dist[i], b->w*sizeof(int));
+	}
+	BoardStats st;
+	scan_board(b, &st);
+	arena_release(b->arena, mark);
+	return ok && (st.nb_open == st.nb_cells-1);
+}
+
+/**
+ * \brief Re-carves random regions of mazes and checks each result with regen_ok()
+ *
+ * \param *arena memory for the boards; reset after each of them
+ * \param *nb_regions where to store the number of regions re-carved
+ * \return the number of wrong regions
+ */
+static int check_regen(Arena *arena, int *nb_regions){
+	const int nb_seeds = sizeof(REGEN_SEEDS)/sizeof(REGEN_SEEDS[0]);
+	const int nb_sizes = sizeof(REGEN_SIZES)/sizeof(REGEN_SIZES[0]);
+	const Layout layouts[] = {ROW_MAJOR, TILED};
+	const GenAlgo algs[] = {BRUTE, SIMUL};
+	int nb_wrong = 0;
+	int i, j, a, l, r, h, w, rh, rw, far_dist;
+	int **dist;
+	Yx corner;
+	Board *b;
+	*nb_regions = 0;
+	for(i=0; i<nb_seeds; i++){
+		for(j=0; j<nb_sizes; j++){
+			for(a=0; a<2; a++){
+				for(l=0; l<2; l++){
+					h = REGEN_SIZES[j][0];
+					w = REGEN_SIZES[j][1];
+					b = new_maze(NULL, 0, REGEN_SEEDS[i], h, w, algs[a], layouts[l], &far_dist, arena);
+					dist = new_distances(b);
+					bfs_distances(b, b->start, dist, &(b->end));
+					for(r=0; r<REGEN_ROUNDS; r++){
+						if(r%5 == 0){
+							corner = new_yx(0, 0);
+							rh = h;
+							rw = w;
+						}else{
+							corner = new_yx(gen_rand()%h, gen_rand()%w);
+							rh = 1+gen_rand()%h;
+							rw = 1+gen_rand()%w;
+						}
+						far_dist = regen_region(NULL, 0, b, dist, &(b->end), corner, rh, rw);
+						(*nb_regions)++;
+						if(!regen_ok(b, dist, far_dist)){
+							nb_wrong++;
+							printf("%10d %4d × %-4d %c %s: regen_region() wrong after region (%d, %d) %d × %d\n", REGEN_SEEDS[i], h, w,
+								alg_letter(algs[a]), (layouts[l] == TILED) ? "tiled" : "row-major", corner.y, corner.x, rh, rw);
+							break;
+						}
+					}
+					free_board(b);
+					arena_reset(arena);
+				}
+			}
+		}
+	}
+	return nb_wrong;
+}
+
+///\brief Reads one case from the start of a line; returns the number of characters read, or 0
+static int read_key(const char *line, Case *c){
+	char alg;
+	int n = 0;
+	if(sscanf(line, "%d %d %d %c%n", &(c->seed), &(c->h), &(c->w), &alg, &n) != 4 || (alg != 'b' && alg != 's')){
+		return 0;
+	}
+	c->alg = (alg == 'b') ? BRUTE : SIMUL;
+	return n;
+}
+
+///\brief Reads a golden file; returns the number of cases, or -1 if it cannot be read
+static int read_golden(const char *path, Case *golden, int max){
+	FILE *f = fopen(path, "r");
+	if(f == NULL) return -1;
+	char line[256];
+	int n = 0, k;
+	Case *c;
+	while(n < max && fgets(line, sizeof(line), f) != NULL){
+		if(line[0] == '#') continue;
+		c = &(golden[n]);
+		k = read_key(line, c);
+		if(k > 0 && sscanf(line+k, "%llx %d %d %d", &(c->hash), &(c->end.y), &(c->end.x), &(c->end_dist)) == 4){
+			c->ms = -1;
+			n++;
+		}
+	}
+	fclose(f);
+	return n;
+}
+
+///\brief Finds the golden case with the same seed, size and algorithm, or NULL
+static Case *find_case(Case *golden, int nb_golden, Case *c){
+	int i;
+	for(i=0; i<nb_golden; i++){
+		if(golden[i].seed == c->seed && golden[i].h == c->h && golden[i].w == c->w && golden[i].alg == c->alg){
+			return &(golden[i]);
+		}
+	}
+	return NULL;
+}
+
+///\brief Name of this machine, for the times file
+static void host_name(char *name, size_t size){
+	if(gethostname(name, size)) strcpy(name, "unknown");
+	name[size-1] = '\0';
+	return;
+}
+
+///\brief Reads a times file into the golden cases; returns false if it cannot be read or was written on another host
+static bool read_times(const char *path, Case *golden, int nb_golden){
+	FILE *f = fopen(path, "r");
+	if(f == NULL) return false;
+	char line[256], host[128], file_host[128];
+	Case key, *g;
+	double ms;
+	int k;
+	host_name(host, sizeof(host));
+	if(fgets(line, sizeof(line), f) == NULL || sscanf(line, "# host %127s", file_host) != 1 || strcmp(host, file_host)){
+		fclose(f);
+		return false;
+	}
+	while(fgets(line, sizeof(line), f) != NULL){
+		if(line[0] == '#') continue;
+		k = read_key(line, &key);
+		if(k > 0 && sscanf(line+k, "%lf", &ms) == 1 && (g = find_case(golden, nb_golden, &key)) != NULL){
+			g->ms = ms;
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+///\brief Writes a golden file, or a times file if times is set; returns false on failure
+static bool write_golden(const char *path, Case *cases, int n, bool times){
+	FILE *f = fopen(path, "w");
+	if(f == NULL) return false;
+	char host[128];
+	int i;
+	if(times){
+		host_name(host, sizeof(host));
+		fprintf(f, "# host %s\n", host);
+		fprintf(f, "# Generation times of the golden cases on this host, written by ltlgolden.out --update-times\n");
+		fprintf(f, "# seed h w alg ms\n");
+	}else{
+		fprintf(f, "# Golden outputs of the maze generators, written by ltlgolden.out --update\n");
+		fprintf(f, "# seed h w alg hash end.y end.x end_dist\n");
+	}
+	for(i=0; i<n; i++){
+		fprintf(f, "%d %d %d %c ", cases[i].seed, cases[i].h, cases[i].w, alg_letter(cases[i].alg));
+		if(times){
+			fprintf(f, "%.3f\n", cases[i].ms);
+		}else{
+			fprintf(f, "%016llx %d %d %d\n", cases[i].hash, cases[i].end.y, cases[i].end.x, cases[i].end_dist);
+		}
+	}
+	return fclose(f) == 0;
+}
+
+/**
+ * \brief Main function of the regression test
+ *
+ * Command-line parameters:
+ * -f/--file FILE: golden file (default ::GOLDEN_FILE)
+ * -m/--times FILE: golden times file (default ::GOLDEN_TIMES_FILE)
+ * -u/--update: writes the golden file instead of checking it
+ * -U/--update-times: writes the times file, if every output matches the golden file
+ * -t/--threshold PCT: fails a case more than PCT% slower than its golden time (default 50, 0 to ignore time)
+ * -r/--runs N: keeps the best time of N generations (default 3)
+ */
+int main(int argc, char *argv[]){
+	const char *path = GOLDEN_FILE;
+	const char *times_path = GOLDEN_TIMES_FILE;
+	bool update = false, update_times = false;
+	double threshold = 50;
+	int nb_runs = 3;
+	int i, j, k;
+
+	//Read through parameters
+	for(i=1; i<argc; i++){
+		if(!strcmp(argv[i], "-u") || !strcmp(argv[i], "--update")){
+			update = true;
+		}else if(!strcmp(argv[i], "-U") || !strcmp(argv[i], "--update-times")){
+			update_times = true;
+		}else if(i+1 == argc){
+			fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}else if(!strcmp(argv[i], "-f") || !strcmp(argv[i], "--file")){
+			path = argv[++i];
+		}else if(!strcmp(argv[i], "-m") || !strcmp(argv[i], "--times")){
+			times_path = argv[++i];
+		}else if(!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threshold")){
+			threshold = strtod(argv[++i], NULL);
+		}else if(!strcmp(argv[i], "-r") || !strcmp(argv[i], "--runs")){
+			nb_runs = (int) strtol(argv[++i], NULL, 10);
+		}else{
+			fprintf(stderr, "Unknown parameter: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(nb_runs < 1 || threshold < 0 || (update && update_times)){
+		fprintf(stderr, "Invalid parameters\n");
+		return EXIT_FAILURE;
+	}
+
+	//The matrix
+	const int nb_seeds = sizeof(SEEDS)/sizeof(SEEDS[0]);
+	const int nb_brute = sizeof(BRUTE_SIZES)/sizeof(BRUTE_SIZES[0]);
+	const int nb_simul = sizeof(SIMUL_SIZES)/sizeof(SIMUL_SIZES[0]);
+	int nb_cases = nb_seeds*(nb_brute+nb_simul);
+	Case *cases = (Case *) calloc(nb_cases, sizeof(Case));
+	Case *golden = (Case *) calloc(nb_cases, sizeof(Case));
+	int n = 0;
+	for(i=0; i<nb_seeds; i++){
+		for(j=0; j<2; j++){
+			for(k=0; k<((j == 0) ? nb_brute : nb_simul); k++){
+				cases[n].seed = SEEDS[i];
+				cases[n].h = (j == 0) ? BRUTE_SIZES[k][0] : SIMUL_SIZES[k][0];
+				cases[n].w = (j == 0) ? BRUTE_SIZES[k][1] : SIMUL_SIZES[k][1];
+				cases[n].alg = (j == 0) ? BRUTE : SIMUL;
+				n++;
+			}
+		}
+	}
+	int nb_golden = 0;
+	bool has_times = false;
+	if(!update){
+		nb_golden = read_golden(path, golden, nb_cases);
+		if(nb_golden < 0){
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		has_times = !update_times && read_times(times_path, golden, nb_golden);
+	}
+	bool check_time = has_times && threshold > 0;
+
+	//Run and compare
+	Arena *arena = new_arena(0);
+	int nb_wrong = 0, nb_slow = 0;
+	double total = 0, golden_total = 0;
+	Case *g;
+	for(i=0; i<nb_cases; i++){
+		Case *c = &(cases[i]);
+		bool same_layouts = run_case(c, nb_runs, arena);
+		total += c->ms;
+		printf("%10d %4d × %-4d %c %10.3f ms", c->seed, c->h, c->w, alg_letter(c->alg), c->ms);
+		if(!same_layouts){
+			nb_wrong++;
+			printf("  LAYOUTS DIFFER\n");
+			continue;
+		}
+		if(update){
+			printf("\n");
+			continue;
+		}
+		g = find_case(golden, nb_golden, c);
+		if(g == NULL){
+			nb_wrong++;
+			printf("  NOT IN %s\n", path);
+		}else if(g->hash != c->hash || g->end.y != c->end.y || g->end.x != c->end.x || g->end_dist != c->end_dist){
+			nb_wrong++;
+			printf("  DIFFERENT MAZE: %016llx end (%d, %d) at %d, golden %016llx end (%d, %d) at %d\n",
+				c->hash, c->end.y, c->end.x, c->end_dist, g->hash, g->end.y, g->end.x, g->end_dist);
+		}else if(!check_time || g->ms < 0){
+			printf("  ok\n");
+		}else{
+			golden_total += g->ms;
+			if(c->ms > g->ms*(1+threshold/100) + GOLDEN_SLACK_MS){
+				nb_slow++;
+				printf("  SLOWER: golden %.3f ms, %+.0f%%\n", g->ms, 100*(c->ms/g->ms-1));
+			}else{
+				printf("  ok (%+.0f%%)\n", (g->ms > 0) ? 100*(c->ms/g->ms-1) : 0.0);
+			}
+		}
+	}
+	int nb_regions = 0, nb_regen_wrong = 0;
+	if(!update && !update_times){
+		nb_regen_wrong = check_regen(arena, &nb_regions);
+	}
+	free_arena(arena);
+
+	int ret = EXIT_SUCCESS;
+	if((update || update_times) && nb_wrong > 0){
+		fprintf(stderr, "%s not written: %s\n", update ? path : times_path,
+			update ? "the layouts disagree" : "the outputs differ from the golden ones");
+		ret = EXIT_FAILURE;
+	}else if(update || update_times){
+		if(write_golden(update ? path : times_path, cases, nb_cases, update_times)){
+			printf("%d cases written to %s (%.0f ms)\n", nb_cases, update ? path : times_path, total);
+		}else{
+			perror(update ? path : times_path);
+			ret = EXIT_FAILURE;
+		}
+	}else{
+		printf("%d cases: %d different, ", nb_cases, nb_wrong);
+		if(check_time){
+			printf("%d slower than %.0f%% over golden; %.0f ms, golden %.0f ms\n", nb_slow, threshold, total, golden_total);
+		}else if(!has_times){
+			printf("time not checked (no %s for this host: write it with --update-times)\n", times_path);
+		}else{
+			printf("time not checked\n");
+		}
+		printf("%d regions re-carved by regen_region(): %d wrong\n", nb_regions, nb_regen_wrong);
+		if(nb_wrong > 0 || nb_slow > 0 || nb_regen_wrong > 0) ret = EXIT_FAILURE;
+	}
+	free(cases);
+	free(golden);
+	return ret;
+}
@@ -0,0 +1,191 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "pack.h"
+#include "proto.h"
+
+/**
+ * \file ltlload.c
+ * \brief Load generator for the maze daemon
+ *
+ * Opens one connection per client thread, sends requests back to back and
+ * reports the throughput and the latency percentiles.
+ */
+
+///\brief Parameters and results of one client thread
+typedef struct{
+	const char *path; ///< \brief Socket of the daemon
+	Request req; ///< \brief Size and algorithm to ask for
+	int nb_seeds; ///< \brief Seeds are drawn in [0, nb_seeds); 0 lets the daemon choose
+	int nb_requests; ///< \brief Number of requests to send
+	unsigned int rand_state; ///< \brief State for rand_r()
+	double *latencies; ///< \brief Latency of each answered request, in microseconds
+	int nb_done; ///< \brief Number of answered requests
+	int nb_errors; ///< \brief Number of refused or failed requests
+} Client;
+
+///\brief Current time in microseconds
+static double now_us(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e6 + t.tv_nsec/1e3;
+}
+
+///\brief Opens a connection to the daemon; returns -1 on failure
+static int connect_to(const char *path){
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd >= 0 && connect(fd, (struct sockaddr *) &addr, sizeof(addr))){
+		close(fd);
+		fd = -1;
+	}
+	return fd;
+}
+
+///\brief Client thread
+static void *client_thread(void *arg){
+	Client *cl = (Client *) arg;
+	char line[REQUEST_MAX_LINE];
+	unsigned char *buf = NULL;
+	size_t cap = 0, len;
+	int i, n, seed;
+	double t0;
+	int fd = connect_to(cl->path);
+	if(fd < 0){
+		perror(cl->path);
+		cl->nb_errors = cl->nb_requests;
+		return NULL;
+	}
+	for(i=0; i<cl->nb_requests; i++){
+		cl->req.any_seed = (cl->nb_seeds == 0);
+		cl->req.seed = cl->req.any_seed ? 0 : (int) (rand_r(&(cl->rand_state)) % cl->nb_seeds);
+		n = format_request(&(cl->req), line, sizeof(line));
+		t0 = now_us();
+		if(!write_all(fd, line, n) || !recv_reply(fd, &seed, &buf, &cap, &len)){
+			cl->nb_errors += cl->nb_requests-i;
+			break;
+		}
+		if(len == 0 || len != packed_size(cl->req.h, cl->req.w)){
+			cl->nb_errors++;
+		}else{
+			cl->latencies[cl->nb_done++] = now_us()-t0;
+		}
+	}
+	close(fd);
+	free(buf);
+	return NULL;
+}
+
+///\brief Comparison function for qsort()
+static int cmp_double(const void *a, const void *b){
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+///\brief Value below which lies the given fraction of the sorted array
+static double percentile(const double *sorted, int n, double p){
+	int i = (int) (p*(n-1) + 0.5);
+	return sorted[i];
+}
+
+/**
+ * \brief Main function of the load generator
+ *
+ * Command-line parameters:
+ * -s/--socket PATH: connects to PATH instead of ::LTLD_SOCKET
+ * -c/--clients N: runs N concurrent clients
+ * -n/--requests N: sends N requests per client
+ * -h/--height N, -w/--width N: asks for boards of that size
+ * -b/--brute, -S/--simul: asks for that algorithm
+ * -k/--seeds N: draws seeds in [0, N); 0 lets the daemon choose
+ */
+int main(int argc, char *argv[]){
+	const char *path = LTLD_SOCKET;
+	int nb_clients = 4;
+	int nb_requests = 1000;
+	int nb_seeds = 1000;
+	Request req = {false, 0, 20, 40, SIMUL};
+	int i;
+
+	//Read through parameters
+	for(i=1; i<argc; i++){
+		if(!strcmp(argv[i], "-b") || !strcmp(argv[i], "--brute")){
+			req.alg = BRUTE;
+		}else if(!strcmp(argv[i], "-S") || !strcmp(argv[i], "--simul")){
+			req.alg = SIMUL;
+		}else if(i+1 == argc){
+			fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}else if(!strcmp(argv[i], "-s") || !strcmp(argv[i], "--socket")){
+			path = argv[++i];
+		}else if(!strcmp(argv[i], "-c") || !strcmp(argv[i], "--clients")){
+			nb_clients = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-n") || !strcmp(argv[i], "--requests")){
+			nb_requests = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--height")){
+			req.h = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-w") || !strcmp(argv[i], "--width")){
+			req.w = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-k") || !strcmp(argv[i], "--seeds")){
+			nb_seeds = (int) strtol(argv[++i], NULL, 10);
+		}else{
+			fprintf(stderr, "Unknown parameter: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(nb_clients < 1 || nb_requests < 1 || nb_seeds < 0 || req.h < 1 || req.w < 1){
+		fprintf(stderr, "Invalid parameters\n");
+		return EXIT_FAILURE;
+	}
+
+	//Run the clients
+	Client *clients = (Client *) calloc(nb_clients, sizeof(Client));
+	pthread_t *threads = (pthread_t *) calloc(nb_clients, sizeof(pthread_t));
+	double t0 = now_us();
+	for(i=0; i<nb_clients; i++){
+		clients[i].path = path;
+		clients[i].req = req;
+		clients[i].nb_seeds = nb_seeds;
+		clients[i].nb_requests = nb_requests;
+		clients[i].rand_state = i+1;
+		clients[i].latencies = (double *) calloc(nb_requests, sizeof(double));
+		pthread_create(&(threads[i]), NULL, client_thread, &(clients[i]));
+	}
+	for(i=0; i<nb_clients; i++){
+		pthread_join(threads[i], NULL);
+	}
+	double elapsed = (now_us()-t0)/1e6;
+
+	//Gather the latencies
+	int nb_done = 0, nb_errors = 0;
+	for(i=0; i<nb_clients; i++){
+		nb_done += clients[i].nb_done;
+		nb_errors += clients[i].nb_errors;
+	}
+	double *all = (double *) calloc(nb_done+1, sizeof(double));
+	int n = 0;
+	for(i=0; i<nb_clients; i++){
+		memcpy(all+n, clients[i].latencies, clients[i].nb_done*sizeof(double));
+		n += clients[i].nb_done;
+		free(clients[i].latencies);
+	}
+	qsort(all, nb_done, sizeof(double), cmp_double);
+
+	printf("%d requests (%d errors) in %.3f s: %.0f requests/s\n", nb_done, nb_errors, elapsed, nb_done/elapsed);
+	if(nb_done > 0){
+		printf("Latency (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+			percentile(all, nb_done, 0.5), percentile(all, nb_done, 0.9),
+			percentile(all, nb_done, 0.99), percentile(all, nb_done, 0.999), all[nb_done-1]);
+	}
+	free(all);
+	free(threads);
+	free(clients);
+	return (nb_errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "data_struct.h"
+#include "gen.h"
+#include "mapped.h"
+#include "solve.h"
+
+/**
+ * \file ltlmap.c
+ * \brief Generation and analysis of boards larger than the memory
+ *
+ * The board lives in a file mapped in memory (see mapped.h). Each phase
+ * reports its time, the memory the process kept resident, and its page
+ * faults. Only brute_gen() can generate such a board: simul_gen() and
+ * bfs_distances() need memory as large as the board.
+ */
+
+///\brief Prints the time and the memory use of a phase, since t0
+static void report(const char *phase, struct timespec *t0){
+	struct timespec t1;
+	struct rusage ru;
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	getrusage(RUSAGE_SELF, &ru);
+	printf("%s: %.1f s, max resident %.1f MB, %ld major and %ld minor page faults so far\n", phase,
+		(t1.tv_sec-t0->tv_sec) + (t1.tv_nsec-t0->tv_nsec)/1e9, ru.ru_maxrss/1024.0, ru.ru_majflt, ru.ru_minflt);
+	clock_gettime(CLOCK_MONOTONIC, t0);
+	return;
+}
+
+/**
+ * \brief Main function of the mapped board tool
+ *
+ * Command-line parameters:
+ * -g/--generate FILE: generates a maze in FILE, then analyzes it
+ * -a/--analyze FILE: analyzes the maze in FILE
+ * -h/--height N, -w/--width N: board size for -g
+ * -s/--seed N: random seed for -g
+ * -b/--brute: brute algorithm, the only one available; -S/--simul is refused
+ * -t/--tiled: stores the board in 8×8 tiles (see Layout)
+ */
+int main(int argc, char *argv[]){
+	const char *gen_path = NULL;
+	const char *path = NULL;
+	int h = 0, w = 0;
+	int seed = 1;
+	Layout layout = ROW_MAJOR;
+	int i;
+
+	//Read through parameters
+	for(i=1; i<argc; i++){
+		if(!strcmp(argv[i], "-t") || !strcmp(argv[i], "--tiled")){
+			layout = TILED;
+		}else if(!strcmp(argv[i], "-b") || !strcmp(argv[i], "--brute")){
+			continue;
+		}else if(!strcmp(argv[i], "-S") || !strcmp(argv[i], "--simul")){
+			fprintf(stderr, "%s: mapped boards can only be generated with the brute algorithm\n", argv[i]);
+			return EXIT_FAILURE;
+		}else if(i+1 == argc){
+			fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}else if(!strcmp(argv[i], "-g") || !strcmp(argv[i], "--generate")){
+			gen_path = path = argv[++i];
+		}else if(!strcmp(argv[i], "-a") || !strcmp(argv[i], "--analyze")){
+			path = argv[++i];
+		}else if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--height")){
+			h = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-w") || !strcmp(argv[i], "--width")){
+			w = (int) strtol(argv[++i], NULL, 10);
+		}else if(!strcmp(argv[i], "-s") || !strcmp(argv[i], "--seed")){
+			seed = (int) strtol(argv[++i], NULL, 10);
+		}else{
+			fprintf(stderr, "Unknown parameter: %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	if(path == NULL || (gen_path != NULL && (h < 1 || w < 1))){
+		fprintf(stderr, "Usage: %s -g FILE -h H -w W [-s SEED] [-t] [-b] | -a FILE\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	struct timespec t0;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	Board *b;
+	if(gen_path != NULL){
+		long long end_dist;
+		b = new_mapped_maze(gen_path, seed, h, w, layout, &end_dist);
+		if(b == NULL){
+			perror(gen_path);
+			return EXIT_FAILURE;
+		}
+		if(!sync_board(b)){
+			perror(gen_path);
+		}
+		advise_board(b, ACCESS_DONE);
+		printf("Board %d × %d = %lld cells, seed %d, end (%d, %d) at %lld\n", h, w, (long long) h*w, seed, b->end.y, b->end.x, end_dist);
+		report("Generation", &t0);
+	}else{
+		b = open_board(path);
+		if(b == NULL){
+			fprintf(stderr, "%s: not a valid board file\n", path);
+			return EXIT_FAILURE;
+		}
+		printf("Board %d × %d = %lld cells, %s, end (%d, %d)\n", b->h, b->w, (long long) b->h*b->w,
+			(b->layout == TILED) ? "tiled" : "row-major", b->end.y, b->end.x);
+	}
+
+	BoardStats st;
+	advise_board(b, ACCESS_SEQUENTIAL);
+	scan_board(b, &st);
+	advise_board(b, ACCESS_DONE);
+	printf("%lld open walls, %lld dead ends, %lld corridors, %lld junctions, %lld closed cells\n",
+		st.nb_open, st.nb_dead_ends, st.nb_corridors, st.nb_junctions, st.nb_closed);
+	bool perfect = (st.nb_open == st.nb_cells-1) && (st.nb_closed == 0 || st.nb_cells == 1);
+	printf("%s\n", perfect ? "As many open walls as a perfect maze" : "NOT A PERFECT MAZE");
+	report("Analysis", &t0);
+	free_board(b);
+	return perfect ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,6 +5,7 @@
 #include "data_struct.h"
 #include "text_ui.h" 
 #include "gen.h"
+#include "movelog.h"
 
 /**
  * \mainpage CLI Maze game in C
@@ -19,6 +20,30 @@
  * This file is where the main() function lives. It should be UI-independent.
  */
 
+///\brief Checks a move log file without the UI, and prints the result
+static int verify_log(const char *path){
+	Board *b;
+	int to_end;
+	MoveLog *log = load_movelog(path, &b, &to_end);
+	if(log == NULL){
+		fprintf(stderr, "%s: not a valid move log\n", path);
+		return EXIT_FAILURE;
+	}
+	struct timespec t0, t1;
+	Yx c;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	long wrong = verify_moves(b, log, &c);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	printf("%zu moves verified in %.3f ms.\n", log->nb, (t1.tv_sec-t0.tv_sec)*1e3 + (t1.tv_nsec-t0.tv_nsec)/1e6);
+	if(wrong >= 0){
+		printf("Move %ld goes through a wall.\n", wrong);
+	}
+	printf("Last cell: (%d, %d), %s.\n", c.y, c.x, (c.y == b->end.y && c.x == b->end.x) ? "the end" : "not the end");
+	free_movelog(log);
+	free_board(b);
+	return (wrong < 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 /**
  * \brief Main function.
  * 
@@ -26,19 +51,18 @@
  * -h/--height N: sets board height to N
  * -w/--width N: sets board width to N
  * -r/--robot N: sets robot to play and lag to Ne-2 seconds.
+ * -o/--log FILE: records the moves in FILE.
+ * -p/--replay FILE: replays the moves recorded in FILE, with the robot lag.
+ * -v/--verify FILE: checks the moves recorded in FILE, without the UI.
+ * -t/--tiled: stores the board in 8×8 tiles instead of rows.
  * N: sets board random seed.
  */
 int main(int argc, char *argv[]){
 	//Parameters that can be modified with the command-line parameters
-	UI* ui = ui_init();
-	ui_clear(ui);
 	float disp_lag = 1;
 	
-	//Board height and width
-	int h, w;
-	Yx start;
-	h = (getmaxy(ui->main_win)-1)/2;
-	w = (getmaxx(ui->main_win)-1)/3;
+	//Board height and width, 0 to fit the screen
+	int h = 0, w = 0;
 	
 	//Played by human or robot and robot lag
 	bool robot = false;
@@ -47,6 +71,12 @@ int main(int argc, char *argv[]){
 	//Board random seed and algorithm
 	int seed = time(NULL);
 	GenAlgo alg = SIMUL;
+	Layout layout = ROW_MAJOR;
+
+	//Move log files
+	const char *log_path = NULL;
+	const char *replay_path = NULL;
+	const char *verify_path = NULL;
 	
 	//Read throught parameters
 	int i=1;
@@ -89,25 +119,66 @@ int main(int argc, char *argv[]){
 			alg = BRUTE;
 		}else if(!strcmp(argv[i], "-s") || !strcmp(argv[i], "--simul")){
 			alg = SIMUL;
+		}else if(!strcmp(argv[i], "-t") || !strcmp(argv[i], "--tiled")){
+			layout = TILED;
+		}else if(!strcmp(argv[i], "-o") || !strcmp(argv[i], "--log")){
+			if(i+1 < argc) log_path = argv[++i];
+		}else if(!strcmp(argv[i], "-p") || !strcmp(argv[i], "--replay")){
+			if(i+1 < argc) replay_path = argv[++i];
+		}else if(!strcmp(argv[i], "-v") || !strcmp(argv[i], "--verify")){
+			if(i+1 < argc) verify_path = argv[++i];
 		}else{
 			seed = (int) strtol(argv[i], NULL, 10);
 		}
 		i++;
 	}
 
+	if(verify_path != NULL){
+		return verify_log(verify_path);
+	}
+
 	//Data instanciation
-	srand(seed);
-	start = new_yx(rand()%h, rand()%w);
-	Board *b = new_board(h, w, start);
-	int to_end = gen_maze(ui, disp_lag, b, alg);
-	Player *plr = new_player(b->start, robot);
+	int to_end;
+	Board *b = NULL;
+	MoveLog *replay = NULL;
+	size_t nb_replayed = 0;
+	if(replay_path != NULL){
+		replay = load_movelog(replay_path, &b, &to_end);
+		if(replay == NULL){
+			fprintf(stderr, "%s: not a valid move log\n", replay_path);
+			return EXIT_FAILURE;
+		}
+	}
+	Arena *arena = new_arena(0);
+	UI* ui = ui_init();
+	ui_clear(ui);
+	if(h <= 0) h = (getmaxy(ui->main_win)-1)/2;
+	if(w <= 0) w = (getmaxx(ui->main_win)-1)/3;
+	if(b == NULL){
+		b = new_maze(ui, disp_lag, seed, h, w, alg, layout, &to_end, arena);
+	}
+	Player *plr = new_player(b->start, robot, arena);
+	if(log_path != NULL){
+		plr->log = new_movelog();
+		if(!movelog_open(plr->log, log_path, b, to_end)){
+			ui_terminate(ui);
+			perror(log_path);
+			return EXIT_FAILURE;
+		}
+	}
 	print_board(ui, b);
 	print_player(ui, plr);
 
 	//Main loop
 	Direction dir = LEFT;
 	while(ui->signal == CONTINUE){
-		if(plr->robot){
+		if(replay != NULL){
+			//Replay
+			if(nb_replayed == replay->nb) break;
+			dir = logged_move(replay, nb_replayed++);
+			msleep(robot_lag);
+			get_user_input(ui);
+		}else if(plr->robot){
 			//Robot
 			dir = opposite_dir(dir);
 			i = 0;
@@ -131,9 +202,25 @@ int main(int argc, char *argv[]){
 
 	printf("\nBoard size: %d(h) × %d(w) = %d cells\n", b->h, b->w, b->h*b->w);
 	printf("Min. path rate: %.2f%%\n", (to_end*100.0)/(b->h*b->w));
-	printf("Seed: %d\n", seed);
+	printf("Arena peak: %.1f kB\n", arena->peak/1024.0);
+	if(replay == NULL){
+		printf("Seed: %d\n", seed);
+	}else{
+		free_movelog(replay);
+	}
+	int ret = EXIT_SUCCESS;
+	if(plr->log != NULL){
+		if(movelog_close(plr->log)){
+			printf("Moves saved in %s\n", log_path);
+		}else{
+			fprintf(stderr, "%s: some moves could not be written\n", log_path);
+			ret = EXIT_FAILURE;
+		}
+		free_movelog(plr->log);
+	}
 	free_player(plr);
 	free_board(b);
-	return EXIT_SUCCESS;
+	free_arena(arena);
+	return ret;
 }
 
@@ -0,0 +1,164 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped.h"
+#include "pack.h"
+
+///\brief Magic number opening every mapped board file
+static const unsigned char MAPPED_MAGIC[4] = {'L', 'T', 'L', 'W'};
+
+///\brief Board in its own arena, whose walls are mapped from an open file
+static Board *map_fd(int fd, const char *path, int h, int w, Yx start, Layout layout, bool create){
+	Arena *arena = new_arena(0);
+	Board *b = (Board *) arena_alloc(arena, sizeof(Board));
+	b->h = h;
+	b->w = w;
+	b->start = start;
+	b->end = start;
+	b->arena = arena;
+	b->own_arena = true;
+	set_layout(b, layout);
+	b->map_size = MAPPED_HEADER_SIZE + 2*b->nb_words*sizeof(uint64_t);
+	b->map_path = (char *) arena_alloc(arena, strlen(path)+1);
+	strcpy(b->map_path, path);
+	b->map = MAP_FAILED;
+	if(!create || ftruncate(fd, b->map_size) == 0){
+		b->map = mmap(NULL, b->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	if(b->map == MAP_FAILED){
+		free_arena(arena);
+		return NULL;
+	}
+	b->walls = (uint64_t *) ((char *) b->map + MAPPED_HEADER_SIZE);
+	return b;
+}
+
+/**
+ * \brief Creates a board whose walls are stored in a file
+ *
+ * \param *path the file; it is overwritten
+ * \param h height
+ * \param w width
+ * \param start where the Player will start
+ * \param layout how the cells are stored
+ * \return the board with every wall up, or NULL if the file cannot be mapped
+ */
+Board *map_board(const char *path, int h, int w, Yx start, Layout layout){
+	if(h <= 0 || w <= 0) return NULL;
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) return NULL;
+	Board *b = map_fd(fd, path, h, w, start, layout, true);
+	close(fd);
+	if(b == NULL) return NULL;
+	unsigned char *head = (unsigned char *) b->map;
+	memcpy(head, MAPPED_MAGIC, 4);
+	put_i32(head+4, h);
+	put_i32(head+8, w);
+	put_i32(head+12, layout);
+	put_i32(head+16, start.y);
+	put_i32(head+20, start.x);
+	put_i32(head+24, start.y);
+	put_i32(head+28, start.x);
+	//Every wall is up
+	advise_board(b, ACCESS_SEQUENTIAL);
+	memset(b->walls, 0xff, 2*b->nb_words*sizeof(uint64_t));
+	return b;
+}
+
+///\brief Maps a board file written by map_board(); returns NULL if it is not valid
+Board *open_board(const char *path){
+	unsigned char head[32];
+	struct stat st;
+	int fd = open(path, O_RDWR);
+	if(fd < 0) return NULL;
+	if(read(fd, head, sizeof(head)) != sizeof(head) || memcmp(head, MAPPED_MAGIC, 4) || fstat(fd, &st)){
+		close(fd);
+		return NULL;
+	}
+	int h = get_i32(head+4);
+	int w = get_i32(head+8);
+	Layout layout = get_i32(head+12);
+	Board *b = NULL;
+	if(h > 0 && w > 0 && (layout == ROW_MAJOR || layout == TILED)){
+		b = map_fd(fd, path, h, w, new_yx(get_i32(head+16), get_i32(head+20)), layout, false);
+	}
+	close(fd);
+	if(b == NULL) return NULL;
+	b->end = new_yx(get_i32(head+24), get_i32(head+28));
+	if((size_t) st.st_size < b->map_size || !exists(b, b->start) || !exists(b, b->end)){
+		free_board(b);
+		return NULL;
+	}
+	return b;
+}
+
+///\brief Writes Board::end in the header and waits for the file to be up to date
+bool sync_board(Board *b){
+	if(b->map == NULL) return false;
+	put_i32((unsigned char *) b->map + 24, b->end.y);
+	put_i32((unsigned char *) b->map + 28, b->end.x);
+	return msync(b->map, b->map_size, MS_SYNC) == 0;
+}
+
+/**
+ * \brief Tells the kernel how the walls will be accessed next
+ *
+ * The generators wander from tile to tile, so readahead would mostly bring
+ * pages that are evicted before they are reached: it is turned off. A scan
+ * in storage order gets aggressive readahead, and its pages are dropped soon
+ * after use. Once a phase is over, dirty pages are written back and dropped,
+ * which keeps the next phase from competing with them for memory. This has no
+ * effect on a board that is not mapped.
+ */
+void advise_board(Board *b, Access access){
+	if(b->map == NULL) return;
+	switch(access){
+	case ACCESS_LOCAL:
+		madvise(b->map, b->map_size, MADV_RANDOM);
+		break;
+	case ACCESS_SEQUENTIAL:
+		madvise(b->map, b->map_size, MADV_SEQUENTIAL);
+		break;
+	case ACCESS_DONE:
+		msync(b->map, b->map_size, MS_ASYNC);
+		madvise(b->map, b->map_size, MADV_DONTNEED);
+		break;
+	}
+	return;
+}
+
+/**
+ * \brief Gets size bytes of scratch memory for a mapped board
+ *
+ * The memory is a mapping of an unlinked file next to the board, so that it
+ * can be written back instead of filling the memory. Aborts on failure, like
+ * arena_alloc().
+ */
+void *map_scratch(Board *b, size_t size){
+	char *tmpl = (char *) malloc(strlen(b->map_path)+8);
+	sprintf(tmpl, "%s.XXXXXX", b->map_path);
+	void *p = MAP_FAILED;
+	int fd = mkstemp(tmpl);
+	if(fd >= 0){
+		unlink(tmpl);
+		if(ftruncate(fd, size) == 0){
+			p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		}
+		close(fd);
+	}
+	if(p == MAP_FAILED){
+		perror(tmpl);
+		abort();
+	}
+	free(tmpl);
+	return p;
+}
+
+///\brief Gives back memory from map_scratch()
+void unmap_scratch(void *p, size_t size){
+	munmap(p, size);
+	return;
+}
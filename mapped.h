@@ -0,0 +1,35 @@
+#ifndef _MAPPED_H_INCLUDED
+#define _MAPPED_H_INCLUDED
+
+/**
+ * \file mapped.h
+ * \brief Boards stored in a file mapped in memory
+ *
+ * The wall planes of a mapped Board live in a file instead of its Arena, so
+ * that a board can be larger than the memory: the kernel reads and writes
+ * back the pages as they are used. The file is a header page (magic "LTLW",
+ * then h, w, layout, start and end as little-endian 32-bit integers) followed
+ * by Board::walls. Scratch memory as large as the board, like the stack of
+ * brute_gen(), is mapped on unlinked files next to it.
+ */
+
+#include <stdbool.h>
+#include "data_struct.h"
+
+///\brief Size of the header of a mapped board; the walls start on the next page
+#define MAPPED_HEADER_SIZE 4096
+
+///\brief How the next phase will go through a mapped Board
+typedef enum{
+	ACCESS_LOCAL, ///< \brief Around a few tiles at a time, like the generators
+	ACCESS_SEQUENTIAL, ///< \brief One pass in storage order, like scan_board()
+	ACCESS_DONE ///< \brief Not for a while: the pages can be written back and dropped
+} Access;
+
+Board *map_board(const char *, int, int, Yx, Layout);
+Board *open_board(const char *);
+bool sync_board(Board *);
+void advise_board(Board *, Access);
+void *map_scratch(Board *, size_t);
+void unmap_scratch(void *, size_t);
+#endif //_MAPPED_H_INCLUDED
@@ -0,0 +1,191 @@
+#include <string.h>
+#include <sys/stat.h>
+#include "movelog.h"
+#include "pack.h"
+
+///\brief Magic number opening every move log file
+static const unsigned char MOVELOG_MAGIC[4] = {'L', 'T', 'L', 'M'};
+///\brief Number of full bytes gathered before they are written to the file
+#define FLUSH_BYTES 4096
+
+///\brief MoveLog constructor
+MoveLog *new_movelog(){
+	MoveLog *log = (MoveLog *) malloc(sizeof(MoveLog));
+	log->cap = 256;
+	log->moves = (unsigned char *) calloc(log->cap, 1);
+	log->nb = 0;
+	log->file = NULL;
+	log->count_pos = 0;
+	log->nb_flushed = 0;
+	log->failed = false;
+	return log;
+}
+
+///\brief MoveLog destructor. Closes the file if there is one.
+void free_movelog(MoveLog *log){
+	if(log->file != NULL) movelog_close(log);
+	free(log->moves);
+	free(log);
+	return;
+}
+
+///\brief Writes the full bytes not written yet; a failure is kept in MoveLog::failed
+static bool flush_moves(MoveLog *log){
+	size_t full = log->nb/4;
+	bool ret = fwrite(log->moves+log->nb_flushed, 1, full-log->nb_flushed, log->file) == full-log->nb_flushed;
+	log->nb_flushed = full;
+	if(!ret) log->failed = true;
+	return ret;
+}
+
+///\brief Records a move
+void log_move(MoveLog *log, Direction dir){
+	if(log->nb/4 == log->cap){
+		log->moves = (unsigned char *) realloc(log->moves, 2*log->cap);
+		memset(log->moves+log->cap, 0, log->cap);
+		log->cap *= 2;
+	}
+	log->moves[log->nb/4] |= (dir & 3) << (2*(log->nb%4));
+	log->nb++;
+	if(log->file != NULL && log->nb/4 - log->nb_flushed >= FLUSH_BYTES){
+		flush_moves(log);
+	}
+	return;
+}
+
+///\brief Gets the i-th recorded move
+Direction logged_move(MoveLog *log, size_t i){
+	return (log->moves[i/4] >> (2*(i%4))) & 3;
+}
+
+/**
+ * \brief Starts writing a log to a file
+ *
+ * \param *log the log, usually still empty
+ * \param *path the file to write
+ * \param *b the board the moves are made on
+ * \param end_dist distance from Board::start to Board::end
+ * \return false if the file could not be written
+ */
+bool movelog_open(MoveLog *log, const char *path, Board *b, int end_dist){
+	FILE *file = fopen(path, "wb");
+	if(file == NULL) return false;
+	size_t len = packed_size(b->h, b->w);
+	unsigned char *buf = (unsigned char *) malloc(len+8);
+	memcpy(buf, MOVELOG_MAGIC, 4);
+	put_i32(buf+4, (int) len);
+	pack_board(b, end_dist, buf+8);
+	bool ret = fwrite(buf, 1, len+8, file) == len+8;
+	free(buf);
+	log->count_pos = ftell(file);
+	log->file = file;
+	log->nb_flushed = 0;
+	log->failed = false;
+	unsigned char count[8] = {0};
+	ret = ret && fwrite(count, 1, 8, file) == 8 && flush_moves(log);
+	return ret;
+}
+
+/**
+ * \brief Writes the remaining moves and their number, and closes the file
+ *
+ * \return false if this or any earlier write to the file failed: the file
+ * may then miss moves, whatever its count says
+ */
+bool movelog_close(MoveLog *log){
+	if(log->file == NULL) return false;
+	bool ret = flush_moves(log);
+	if(log->nb%4){
+		ret = ret && fwrite(log->moves+log->nb_flushed, 1, 1, log->file) == 1;
+	}
+	unsigned char count[8];
+	put_i32(count, (int) (log->nb & 0xffffffff));
+	put_i32(count+4, (int) ((unsigned long long) log->nb >> 32));
+	ret = ret && !fseek(log->file, log->count_pos, SEEK_SET) && fwrite(count, 1, 8, log->file) == 8;
+	ret = !fclose(log->file) && ret && !log->failed;
+	log->file = NULL;
+	return ret;
+}
+
+/**
+ * \brief Reads a log file
+ *
+ * The number of moves is only written by movelog_close(). If it is still 0
+ * but moves follow, the game was interrupted: the log holds the moves flushed
+ * until then, four per byte.
+ *
+ * \param *path the file to read
+ * \param **b where to store the board the moves were made on
+ * \param *end_dist where to store the distance to Board::end
+ * \return the log, or NULL if the file is not a valid move log or memory is short
+ */
+MoveLog *load_movelog(const char *path, Board **b, int *end_dist){
+	FILE *file = fopen(path, "rb");
+	if(file == NULL) return NULL;
+	unsigned char header[8];
+	unsigned char *buf = NULL;
+	unsigned char *moves;
+	MoveLog *log = NULL;
+	struct stat st;
+	size_t len, size, nb;
+	*b = NULL;
+	if(fstat(fileno(file), &st) || st.st_size < 16) goto end;
+	size = st.st_size - 16;
+	if(fread(header, 1, 8, file) != 8 || memcmp(header, MOVELOG_MAGIC, 4)) goto end;
+	len = (unsigned int) get_i32(header+4);
+	if(len > size || (buf = (unsigned char *) malloc(len)) == NULL) goto end;
+	if(fread(buf, 1, len, file) != len || (*b = unpack_board(buf, len, end_dist)) == NULL) goto end;
+	if(fread(header, 1, 8, file) != 8) goto end;
+	size -= len;
+	nb = (unsigned int) get_i32(header) | ((size_t) (unsigned int) get_i32(header+4) << 32);
+	if(nb == 0) nb = 4*size;
+	//Every move must be in the file; nb+3 may overflow
+	if(nb/4 > size || (nb+3)/4 > size) goto end;
+	log = new_movelog();
+	log->cap = (nb+3)/4;
+	moves = (unsigned char *) realloc(log->moves, log->cap ? log->cap : 1);
+	if(moves == NULL){
+		free_movelog(log);
+		log = NULL;
+		goto end;
+	}
+	log->moves = moves;
+	log->nb = nb;
+	if(fread(log->moves, 1, log->cap, file) != log->cap){
+		free_movelog(log);
+		log = NULL;
+	}
+end:
+	if(log == NULL && *b != NULL){
+		free_board(*b);
+		*b = NULL;
+	}
+	free(buf);
+	fclose(file);
+	return log;
+}
+
+/**
+ * \brief Checks that a log only goes through open walls
+ *
+ * \param *b the board, on which the moves start from Board::start
+ * \param *log the moves
+ * \param *end where to store the cell reached, before the first wrong move
+ * \return the index of the first move through a wall, or -1 if there is none
+ */
+long verify_moves(Board *b, MoveLog *log, Yx *end){
+	Yx c = b->start;
+	Direction dir;
+	size_t i;
+	long ret = -1;
+	for(i=0; i<log->nb; i++){
+		dir = logged_move(log, i);
+		if(get_wall(b, c, dir)){
+			ret = i;
+			break;
+		}
+		c = get_neigh(b, c, dir);
+	}
+	*end = c;
+	return ret;
+}
@@ -0,0 +1,38 @@
+#ifndef _MOVELOG_H_INCLUDED
+#define _MOVELOG_H_INCLUDED
+
+/**
+ * \file movelog.h
+ * \brief Compact record of the moves of a Player
+ *
+ * Every move is stored as a 2-bit Direction, four moves per byte, the first
+ * one in the lowest bits. A log can be flushed to a file as it grows. The file
+ * holds the packed board (see pack.h), the number of moves, then the moves, so
+ * that it can be replayed or verified on its own. The number is written when
+ * the log is closed: until then it is 0, and the moves already flushed are all
+ * that a reader gets.
+ */
+
+#include <stdio.h>
+#include "data_struct.h"
+
+///\brief Packed list of moves
+struct _move_log_struct{
+	unsigned char *moves; ///< \brief Moves, four per byte
+	size_t nb; ///< \brief Number of moves
+	size_t cap; ///< \brief Number of bytes allocated in MoveLog::moves
+	FILE *file; ///< \brief File the moves are flushed to, or NULL
+	long count_pos; ///< \brief Offset of the number of moves in MoveLog::file
+	size_t nb_flushed; ///< \brief Number of bytes already written to MoveLog::file
+	bool failed; ///< \brief Whether a write to MoveLog::file failed, kept until movelog_close()
+};
+
+MoveLog *new_movelog();
+void free_movelog(MoveLog *);
+void log_move(MoveLog *, Direction);
+Direction logged_move(MoveLog *, size_t);
+bool movelog_open(MoveLog *, const char *, Board *, int);
+bool movelog_close(MoveLog *);
+MoveLog *load_movelog(const char *, Board **, int *);
+long verify_moves(Board *, MoveLog *, Yx *);
+#endif //_MOVELOG_H_INCLUDED
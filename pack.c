@@ -0,0 +1,122 @@
+#include "pack.h"
+
+///\brief Magic number opening every packed board
+static const unsigned char PACK_MAGIC[4] = {'L', 'T', 'L', 'B'};
+
+///\brief Writes a 32-bit integer in little-endian order
+void put_i32(unsigned char *p, int v){
+	unsigned int u = (unsigned int) v;
+	p[0] = u & 0xff;
+	p[1] = (u >> 8) & 0xff;
+	p[2] = (u >> 16) & 0xff;
+	p[3] = (u >> 24) & 0xff;
+	return;
+}
+
+///\brief Reads a 32-bit integer in little-endian order
+int get_i32(const unsigned char *p){
+	return (int) (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24));
+}
+
+///\brief Number of bytes needed to pack a board of given height and width
+size_t packed_size(int h, int w){
+	return PACK_HEADER_SIZE + ((size_t) h*w*2 + 7)/8;
+}
+
+/**
+ * \brief Encodes a board
+ *
+ * \param *b the board to encode
+ * \param end_dist distance from Board::start to Board::end
+ * \param *buf where to write; must hold at least packed_size() bytes
+ * \return the number of bytes written
+ */
+size_t pack_board(Board *b, int end_dist, unsigned char *buf){
+	size_t len = packed_size(b->h, b->w);
+	int i, j;
+	Cell cell;
+	size_t bit = 0;
+	memcpy(buf, PACK_MAGIC, 4);
+	put_i32(buf+4, b->h);
+	put_i32(buf+8, b->w);
+	put_i32(buf+12, b->start.y);
+	put_i32(buf+16, b->start.x);
+	put_i32(buf+20, b->end.y);
+	put_i32(buf+24, b->end.x);
+	put_i32(buf+28, end_dist);
+	memset(buf+PACK_HEADER_SIZE, 0, len-PACK_HEADER_SIZE);
+	unsigned char *bits = buf+PACK_HEADER_SIZE;
+	for(i=0; i<b->h; i++){
+		for(j=0; j<b->w; j++){
+			cell = get_cell(b, new_yx(i, j));
+			if(cell.top)  bits[bit/8] |= 1 << (bit%8);
+			bit++;
+			if(cell.left) bits[bit/8] |= 1 << (bit%8);
+			bit++;
+		}
+	}
+	return len;
+}
+
+/**
+ * \brief Hash of the walls of a board (64-bit FNV-1a)
+ *
+ * It is computed over the bytes pack_board() writes after its header, without
+ * writing them: the same maze has the same hash whatever its Layout.
+ */
+unsigned long long hash_board(Board *b){
+	unsigned long long hash = 1469598103934665603ULL;
+	unsigned int byte = 0;
+	int i, j;
+	Cell cell;
+	size_t bit = 0;
+	for(i=0; i<b->h; i++){
+		for(j=0; j<b->w; j++){
+			cell = get_cell(b, new_yx(i, j));
+			byte |= (cell.top | cell.left << 1) << (bit%8);
+			bit += 2;
+			if(bit%8 == 0){
+				hash = (hash ^ byte) * 1099511628211ULL;
+				byte = 0;
+			}
+		}
+	}
+	if(bit%8) hash = (hash ^ byte) * 1099511628211ULL;
+	return hash;
+}
+
+/**
+ * \brief Decodes a board
+ *
+ * \param *buf the packed board
+ * \param len number of bytes available in buf
+ * \param *end_dist where to store the distance to Board::end; may be NULL
+ * \return a new board, or NULL if buf does not hold a valid packed board
+ */
+Board *unpack_board(const unsigned char *buf, size_t len, int *end_dist){
+	if(len < PACK_HEADER_SIZE || memcmp(buf, PACK_MAGIC, 4)) return NULL;
+	int h = get_i32(buf+4);
+	int w = get_i32(buf+8);
+	if(h <= 0 || w <= 0 || len < packed_size(h, w)) return NULL;
+	Board *b = new_board(h, w, new_yx(get_i32(buf+12), get_i32(buf+16)), ROW_MAJOR, NULL);
+	b->end = new_yx(get_i32(buf+20), get_i32(buf+24));
+	if(!exists(b, b->start) || !exists(b, b->end)){
+		free_board(b);
+		return NULL;
+	}
+	if(end_dist != NULL) *end_dist = get_i32(buf+28);
+	const unsigned char *bits = buf+PACK_HEADER_SIZE;
+	int i, j;
+	Cell cell;
+	size_t bit = 0;
+	for(i=0; i<h; i++){
+		for(j=0; j<w; j++){
+			cell.top = (bits[bit/8] >> (bit%8)) & 1;
+			bit++;
+			cell.left = (bits[bit/8] >> (bit%8)) & 1;
+			bit++;
+			set_cell(b, new_yx(i, j), cell);
+		}
+	}
+	return b;
+}
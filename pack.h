@@ -0,0 +1,27 @@
+#ifndef _PACK_H_INCLUDED
+#define _PACK_H_INCLUDED
+
+/**
+ * \file pack.h
+ * \brief Compact binary encoding of a Board
+ *
+ * A packed board is a fixed header followed by the walls, two bits per cell
+ * (Cell::top then Cell::left) in row-major order. All integers are stored
+ * little-endian so that packed boards can be kept in files or sent over a
+ * socket.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "data_struct.h"
+
+///\brief Size in bytes of the header of a packed board
+#define PACK_HEADER_SIZE 32
+
+void put_i32(unsigned char *, int);
+int get_i32(const unsigned char *);
+size_t packed_size(int, int);
+size_t pack_board(Board *, int, unsigned char *);
+unsigned long long hash_board(Board *);
+Board *unpack_board(const unsigned char *, size_t, int *);
+#endif //_PACK_H_INCLUDED
@@ -0,0 +1,159 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "proto.h"
+#include "pack.h"
+
+///\brief Writes exactly len bytes, retrying on short writes
+bool write_all(int fd, const void *buf, size_t len){
+	const char *p = buf;
+	ssize_t n;
+	while(len > 0){
+		n = write(fd, p, len);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+///\brief Reads exactly len bytes, retrying on short reads
+bool read_all(int fd, void *buf, size_t len){
+	char *p = buf;
+	ssize_t n;
+	while(len > 0){
+		n = read(fd, p, len);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+///\brief LineReader constructor
+void init_reader(LineReader *r, int fd){
+	r->fd = fd;
+	r->pos = 0;
+	r->len = 0;
+	r->eof = false;
+	return;
+}
+
+/**
+ * \brief Reads once from the file, to be called when poll() says it is readable
+ *
+ * \param *r the reader
+ * \return false at end of file, on error, or if LineReader::buf is full
+ * without a complete line
+ */
+bool fill_reader(LineReader *r){
+	ssize_t got;
+	if(r->pos > 0){
+		memmove(r->buf, r->buf+r->pos, r->len-r->pos);
+		r->len -= r->pos;
+		r->pos = 0;
+	}
+	if(r->len == sizeof(r->buf)) return false;
+	do{
+		got = read(r->fd, r->buf+r->len, sizeof(r->buf)-r->len);
+	}while(got < 0 && errno == EINTR);
+	if(got <= 0){
+		r->eof = true;
+		return false;
+	}
+	r->len += got;
+	return true;
+}
+
+/**
+ * \brief Takes one line read by fill_reader(), without its end-of-line character
+ *
+ * Once the end of file is reached, an unterminated last line is taken too.
+ *
+ * \param *r the reader
+ * \param *line where to store the line, NUL-terminated
+ * \param size size of line; longer lines are truncated
+ * \return the length of the line, or -1 if no whole line was read yet
+ */
+int take_line(LineReader *r, char *line, size_t size){
+	char *start = r->buf+r->pos;
+	char *end = (char *) memchr(start, '\n', r->len-r->pos);
+	size_t n;
+	if(end == NULL){
+		if(!r->eof || r->pos == r->len) return -1;
+		end = r->buf+r->len;
+		r->pos = r->len;
+	}else{
+		r->pos += end-start+1;
+	}
+	n = end-start;
+	if(n+1 > size) n = size-1;
+	memcpy(line, start, n);
+	line[n] = '\0';
+	return n;
+}
+
+///\brief Reads a request line; returns false if it is malformed
+bool parse_request(const char *line, Request *req){
+	char seed[24], alg[8];
+	if(sscanf(line, "%23s %d %d %7s", seed, &(req->h), &(req->w), alg) != 4) return false;
+	if(!strcmp(seed, "*")){
+		req->any_seed = true;
+		req->seed = 0;
+	}else{
+		char *conv_test;
+		req->any_seed = false;
+		req->seed = (int) strtol(seed, &conv_test, 10);
+		if(*conv_test != '\0') return false;
+	}
+	if(!strcmp(alg, "b") || !strcmp(alg, "brute")){
+		req->alg = BRUTE;
+	}else if(!strcmp(alg, "s") || !strcmp(alg, "simul")){
+		req->alg = SIMUL;
+	}else{
+		return false;
+	}
+	return (req->h > 0) && (req->w > 0);
+}
+
+///\brief Writes a request line into buf; returns its length
+int format_request(const Request *req, char *buf, size_t size){
+	const char *alg = (req->alg == BRUTE) ? "b" : "s";
+	if(req->any_seed){
+		return snprintf(buf, size, "* %d %d %s\n", req->h, req->w, alg);
+	}
+	return snprintf(buf, size, "%d %d %d %s\n", req->seed, req->h, req->w, alg);
+}
+
+///\brief Sends a reply: header, then len bytes of packed board
+bool send_reply(int fd, int seed, const unsigned char *data, size_t len){
+	unsigned char header[REPLY_HEADER_SIZE];
+	put_i32(header, (int) len);
+	put_i32(header+4, seed);
+	return write_all(fd, header, REPLY_HEADER_SIZE) && ((len == 0) || write_all(fd, data, len));
+}
+
+/**
+ * \brief Receives a reply
+ *
+ * \param fd socket to read from
+ * \param *seed where to store the seed used by the daemon
+ * \param **buf buffer for the packed board, grown with realloc() if needed
+ * \param *cap capacity of *buf
+ * \param *len where to store the length of the packed board, 0 if refused
+ * \return false if the connection failed
+ */
+bool recv_reply(int fd, int *seed, unsigned char **buf, size_t *cap, size_t *len){
+	unsigned char header[REPLY_HEADER_SIZE];
+	if(!read_all(fd, header, REPLY_HEADER_SIZE)) return false;
+	*len = (unsigned int) get_i32(header);
+	*seed = get_i32(header+4);
+	if(*len > *cap){
+		*buf = (unsigned char *) realloc(*buf, *len);
+		*cap = *len;
+	}
+	return read_all(fd, *buf, *len);
+}
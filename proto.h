@@ -0,0 +1,54 @@
+#ifndef _PROTO_H_INCLUDED
+#define _PROTO_H_INCLUDED
+
+/**
+ * \file proto.h
+ * \brief Protocol between the maze daemon (ltld) and its clients
+ *
+ * A client connects to the Unix socket and sends any number of request
+ * lines of the form `SEED H W ALG`, where SEED is an integer or `*` to let
+ * the daemon choose, and ALG is `b` (BRUTE) or `s` (SIMUL). For every line,
+ * the daemon answers with an 8-byte header (length of the packed board and
+ * seed used, little-endian) followed by the board as encoded in pack.h. A
+ * length of 0 means the request was refused.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "gen.h"
+
+///\brief Default path of the daemon socket
+#define LTLD_SOCKET "/tmp/ltld.sock"
+///\brief Size in bytes of a reply header
+#define REPLY_HEADER_SIZE 8
+///\brief Maximal length of a request line
+#define REQUEST_MAX_LINE 64
+
+///\brief A request for a maze
+typedef struct{
+	bool any_seed; ///< \brief True if the daemon may choose the seed
+	int seed; ///< \brief Random seed, unused if Request::any_seed
+	int h; ///< \brief Board height
+	int w; ///< \brief Board width
+	GenAlgo alg; ///< \brief Generation algorithm
+} Request;
+
+///\brief Buffered reader for request lines
+typedef struct{
+	int fd; ///< \brief File descriptor to read from
+	size_t pos; ///< \brief Index of the first unread byte in LineReader::buf
+	size_t len; ///< \brief Number of bytes in LineReader::buf
+	char buf[512]; ///< \brief Bytes read but not consumed yet
+	bool eof; ///< \brief Whether the end of file was reached
+} LineReader;
+
+bool write_all(int, const void *, size_t);
+bool read_all(int, void *, size_t);
+void init_reader(LineReader *, int);
+bool fill_reader(LineReader *);
+int take_line(LineReader *, char *, size_t);
+bool parse_request(const char *, Request *);
+int format_request(const Request *, char *, size_t);
+bool send_reply(int, int, const unsigned char *, size_t);
+bool recv_reply(int, int *, unsigned char **, size_t *, size_t *);
+#endif //_PROTO_H_INCLUDED
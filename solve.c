@@ -0,0 +1,353 @@
+#include <pthread.h>
+#include <string.h>
+#include "solve.h"
+
+///\brief Allocates an uninitialized array[h][w] of distances in the arena of the board
+int **new_distances(Board *b){
+	int **dist = (int **) arena_alloc(b->arena, b->h*sizeof(int *));
+	int i;
+	for(i=0; i<b->h; i++){
+		dist[i] = (int *) arena_alloc(b->arena, b->w*sizeof(int));
+	}
+	return dist;
+}
+
+///\brief Whether cell c at distance d beats the farthest cell so far: farther, or as far and first in row-major order
+bool is_farther(int d, Yx c, int far_dist, Yx far){
+	return (d > far_dist) || (d == far_dist && (c.y < far.y || (c.y == far.y && c.x < far.x)));
+}
+
+/**
+ * \brief Computes the distance from one cell to every other cell
+ *
+ * \param *b the board
+ * \param from the cell from which distances are counted
+ * \param **dist an array from new_distances(); unreachable cells are set to -1
+ * \param *far where to store the farthest cell, the first one in row-major order if there are several; may be NULL
+ * \return the distance to the farthest cell
+ */
+int bfs_distances(Board *b, Yx from, int **dist, Yx *far){
+	size_t mark = arena_mark(b->arena);
+	Yx *queue = (Yx *) arena_alloc(b->arena, (size_t) b->h*b->w*sizeof(Yx));
+	size_t first = 0, last = 0;
+	Yx c, n;
+	Yx far_cell = from;
+	int far_dist = 0;
+	Direction dir;
+	int i, j;
+	for(i=0; i<b->h; i++){
+		for(j=0; j<b->w; j++){
+			dist[i][j] = -1;
+		}
+	}
+	dist[from.y][from.x] = 0;
+	queue[last++] = from;
+	while(first < last){
+		c = queue[first++];
+		for(dir=RIGHT; dir<ERROR; dir++){
+			n = get_neigh(b, c, dir);
+			if(!get_wall(b, c, dir) && dist[n.y][n.x] < 0){
+				dist[n.y][n.x] = dist[c.y][c.x]+1;
+				queue[last++] = n;
+				if(is_farther(dist[n.y][n.x], n, far_dist, far_cell)){
+					far_dist = dist[n.y][n.x];
+					far_cell = n;
+				}
+			}
+		}
+	}
+	if(far != NULL) *far = far_cell;
+	arena_release(b->arena, mark);
+	return far_dist;
+}
+
+/**
+ * \brief Shortest path from the origin of a distance array to a cell
+ *
+ * \param *b the board
+ * \param **dist distances set by bfs_distances() or par_bfs_distances()
+ * \param to the last cell of the path
+ * \param *path where to store the dist[to.y][to.x] moves, from the origin
+ * \return the number of moves, or -1 if to cannot be reached
+ *
+ * Going back from to, the first Direction leading one step nearer is taken,
+ * so that a given distance array always gives the same path.
+ */
+int shortest_path(Board *b, int **dist, Yx to, Direction *path){
+	int d = dist[to.y][to.x];
+	int len = d;
+	Yx n;
+	Direction dir;
+	while(d > 0){
+		for(dir=RIGHT; dir<ERROR; dir++){
+			n = get_neigh(b, to, dir);
+			if(!get_wall(b, to, dir) && dist[n.y][n.x] == d-1) break;
+		}
+		path[--d] = opposite_dir(dir);
+		to = n;
+	}
+	return len;
+}
+
+///\brief State shared by the threads of par_bfs_distances()
+typedef struct{
+	Board *b; ///< \brief The board
+	Yx from; ///< \brief Origin of the distances
+	int **dist; ///< \brief The distances
+	uint64_t *bits[2]; ///< \brief Cells reached during the even and odd levels, indexed like the wall planes
+	uint64_t *visited; ///< \brief Cells reached so far
+	size_t *words[2]; ///< \brief Indices of the non-empty words of ParBfs::bits
+	size_t nb_words[2]; ///< \brief Number of indices in ParBfs::words
+	size_t nb_cells[2]; ///< \brief Number of cells in ParBfs::bits
+	int nb_threads; ///< \brief Number of threads
+	int min_cells; ///< \brief Cells per thread below which a level is expanded by the first thread alone
+	pthread_barrier_t barrier; ///< \brief Where the threads wait for each other
+	int level; ///< \brief Level reached when the first thread worked alone
+} ParBfs;
+
+///\brief One thread of par_bfs_distances()
+typedef struct{
+	ParBfs *p; ///< \brief Shared state
+	int id; ///< \brief Rank of the thread, from 0
+	Yx far; ///< \brief Farthest cell reached by this thread
+	int far_dist; ///< \brief Distance to ParBfsThread::far
+} ParBfsThread;
+
+///\brief Expands the words [lo, hi) of the list of a level into the next level
+static void expand_words(ParBfsThread *t, int level, size_t lo, size_t hi){
+	ParBfs *p = t->p;
+	Board *b = p->b;
+	uint64_t *cur = p->bits[level%2], *next = p->bits[(level+1)%2];
+	size_t *list = p->words[level%2];
+	uint64_t f, mask;
+	size_t j, k, i, ni;
+	Yx c, n;
+	Direction dir;
+	bool wall;
+	size_t nb_cells = 0;
+	for(j=lo; j<hi; j++){
+		k = list[j];
+		f = cur[k];
+		while(f != 0){
+			i = k*64 + __builtin_ctzll(f);
+			f &= f-1;
+			c = cell_coords(b, i);
+			for(dir=RIGHT; dir<ERROR; dir++){
+				n = get_neigh(b, c, dir);
+				ni = cell_index(b, n.y, n.x);
+				//UP and LEFT walls are stored with c, RIGHT and DOWN ones with n
+				if(dir == UP || dir == LEFT){
+					wall = (b->walls[2*k + (dir == LEFT)] >> (i%64)) & 1;
+				}else{
+					wall = (b->walls[2*(ni/64) + (dir == RIGHT)] >> (ni%64)) & 1;
+				}
+				mask = (uint64_t) 1 << (ni%64);
+				if(wall || (__atomic_load_n(&(p->visited[ni/64]), __ATOMIC_RELAXED) & mask)) continue;
+				if(__atomic_fetch_or(&(p->visited[ni/64]), mask, __ATOMIC_RELAXED) & mask) continue;
+				if(__atomic_fetch_or(&(next[ni/64]), mask, __ATOMIC_RELAXED) == 0){
+					p->words[(level+1)%2][__atomic_fetch_add(&(p->nb_words[(level+1)%2]), 1, __ATOMIC_RELAXED)] = ni/64;
+				}
+				p->dist[n.y][n.x] = level+1;
+				nb_cells++;
+				if(is_farther(level+1, n, t->far_dist, t->far)){
+					t->far_dist = level+1;
+					t->far = n;
+				}
+			}
+		}
+	}
+	__atomic_fetch_add(&(p->nb_cells[(level+1)%2]), nb_cells, __ATOMIC_RELAXED);
+	return;
+}
+
+///\brief Empties the words [lo, hi) of the list of a level, once it has been expanded
+static void clear_words(ParBfs *p, int level, size_t lo, size_t hi){
+	size_t j;
+	for(j=lo; j<hi; j++){
+		p->bits[level%2][p->words[level%2][j]] = 0;
+	}
+	return;
+}
+
+/**
+ * \brief Goes through the levels with the other threads
+ *
+ * Every thread reads the size of the level before any of them changes it.
+ * Levels of less than ParBfs::min_cells cells per thread are expanded by the
+ * first thread alone, until one is large enough, while the others wait: two
+ * barriers cost more than a handful of cells, and the mazes of brute_gen()
+ * have long stretches of such levels.
+ */
+static void *par_bfs_thread(void *arg){
+	ParBfsThread *t = (ParBfsThread *) arg;
+	ParBfs *p = t->p;
+	Board *b = p->b;
+	size_t nb, min = (size_t) p->min_cells*p->nb_threads, lo, hi;
+	int y, x, level = 0;
+
+	//Distances of the lines of this thread
+	for(y=b->h*t->id/p->nb_threads; y<b->h*(t->id+1)/p->nb_threads; y++){
+		for(x=0; x<b->w; x++){
+			p->dist[y][x] = (y == p->from.y && x == p->from.x) ? 0 : -1;
+		}
+	}
+	pthread_barrier_wait(&(p->barrier));
+
+	for(;;){
+		nb = p->nb_words[level%2];
+		if(nb == 0) break;
+		if(p->nb_cells[level%2] < min){
+			//Small levels: the first thread alone
+			pthread_barrier_wait(&(p->barrier));
+			if(t->id == 0){
+				do{
+					expand_words(t, level, 0, nb);
+					clear_words(p, level, 0, nb);
+					p->nb_words[level%2] = 0;
+					p->nb_cells[level%2] = 0;
+					level++;
+					nb = p->nb_words[level%2];
+				}while(nb > 0 && p->nb_cells[level%2] < min);
+				p->level = level;
+			}
+			pthread_barrier_wait(&(p->barrier));
+			level = p->level;
+		}else{
+			//Large levels: every thread its own range of words
+			lo = nb * t->id / p->nb_threads;
+			hi = nb * (t->id+1) / p->nb_threads;
+			expand_words(t, level, lo, hi);
+			pthread_barrier_wait(&(p->barrier));
+			clear_words(p, level, lo, hi);
+			if(t->id == 0){
+				p->nb_words[level%2] = 0;
+				p->nb_cells[level%2] = 0;
+			}
+			pthread_barrier_wait(&(p->barrier));
+			level++;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Computes the same distances as bfs_distances(), with several threads
+ *
+ * \param *b the board
+ * \param from the cell from which distances are counted
+ * \param **dist an array from new_distances(); unreachable cells are set to -1
+ * \param *far where to store the farthest cell, as bfs_distances() does; may be NULL
+ * \param nb_threads number of threads, including the calling one
+ * \param min_cells cells per thread below which a level is not split, usually ::PAR_MIN_CELLS; 0 splits every level
+ * \return the distance to the farthest cell
+ *
+ * The search goes level by level. The cells of a level and those already
+ * reached are bitsets laid out like the wall planes, along with the list of
+ * the non-empty words of the level. Each thread expands its own range of that
+ * list, reading the walls straight from Board::walls. A cell of the next level
+ * is claimed with an atomic or on the visited set, so it is reached only
+ * once: the levels, hence the distances, do not depend on the interleaving.
+ * With a single thread, this is bfs_distances().
+ */
+int par_bfs_distances(Board *b, Yx from, int **dist, Yx *far, int nb_threads, int min_cells){
+	if(nb_threads <= 1) return bfs_distances(b, from, dist, far);
+	if(min_cells < 0) min_cells = 0;
+	size_t mark = arena_mark(b->arena);
+	size_t bytes = b->nb_words*sizeof(uint64_t);
+	ParBfs *p = (ParBfs *) arena_alloc(b->arena, sizeof(ParBfs));
+	ParBfsThread *threads = (ParBfsThread *) arena_alloc(b->arena, nb_threads*sizeof(ParBfsThread));
+	pthread_t *ids = (pthread_t *) arena_alloc(b->arena, nb_threads*sizeof(pthread_t));
+	int i;
+	p->b = b;
+	p->from = from;
+	p->dist = dist;
+	p->visited = (uint64_t *) arena_alloc(b->arena, bytes);
+	memset(p->visited, 0, bytes);
+	for(i=0; i<2; i++){
+		p->bits[i] = (uint64_t *) arena_alloc(b->arena, bytes);
+		memset(p->bits[i], 0, bytes);
+		p->words[i] = (size_t *) arena_alloc(b->arena, b->nb_words*sizeof(size_t));
+		p->nb_words[i] = 0;
+		p->nb_cells[i] = 0;
+	}
+	size_t start = cell_index(b, from.y, from.x);
+	p->bits[0][start/64] = (uint64_t) 1 << (start%64);
+	p->visited[start/64] = p->bits[0][start/64];
+	p->words[0][0] = start/64;
+	p->nb_words[0] = 1;
+	p->nb_cells[0] = 1;
+	p->nb_threads = nb_threads;
+	p->min_cells = min_cells;
+	p->level = 0;
+	pthread_barrier_init(&(p->barrier), NULL, nb_threads);
+	for(i=0; i<nb_threads; i++){
+		threads[i].p = p;
+		threads[i].id = i;
+		threads[i].far = from;
+		threads[i].far_dist = 0;
+		if(i > 0) pthread_create(&(ids[i]), NULL, par_bfs_thread, &(threads[i]));
+	}
+	par_bfs_thread(&(threads[0]));
+	for(i=1; i<nb_threads; i++){
+		pthread_join(ids[i], NULL);
+	}
+	pthread_barrier_destroy(&(p->barrier));
+
+	Yx far_cell = from;
+	int far_dist = 0;
+	for(i=0; i<nb_threads; i++){
+		if(is_farther(threads[i].far_dist, threads[i].far, far_dist, far_cell)){
+			far_dist = threads[i].far_dist;
+			far_cell = threads[i].far;
+		}
+	}
+	if(far != NULL) *far = far_cell;
+	arena_release(b->arena, mark);
+	return far_dist;
+}
+
+/**
+ * \brief Counts the open walls and the kinds of cells of a board
+ *
+ * \param *b the board
+ * \param *st where to store the counts
+ *
+ * Cells are visited in the order in which they are stored, tile by tile for
+ * the TILED layout: apart from the walls below the last line of a tile, every
+ * word is read once, one after the other. This is how a board too large for
+ * the memory can be checked (see mapped.h). A perfect maze has one open wall
+ * less than cells, and no closed cell.
+ */
+void scan_board(Board *b, BoardStats *st){
+	int th = (b->layout == TILED) ? 8 : 1;
+	int tw = (b->layout == TILED) ? 8 : b->w;
+	int ty, tx, y, x, nb_ways;
+	Yx c;
+	Direction dir;
+	memset(st, 0, sizeof(BoardStats));
+	for(ty=0; ty<b->h; ty+=th){
+		for(tx=0; tx<b->w; tx+=tw){
+			for(y=ty; y<ty+th && y<b->h; y++){
+				for(x=tx; x<tx+tw && x<b->w; x++){
+					c = new_yx(y, x);
+					nb_ways = 0;
+					for(dir=RIGHT; dir<ERROR; dir++){
+						nb_ways += !get_wall(b, c, dir);
+					}
+					st->nb_open += !get_wall(b, c, UP) + !get_wall(b, c, LEFT);
+					if(nb_ways == 0){
+						st->nb_closed++;
+					}else if(nb_ways == 1){
+						st->nb_dead_ends++;
+					}else if(nb_ways == 2){
+						st->nb_corridors++;
+					}else{
+						st->nb_junctions++;
+					}
+				}
+			}
+		}
+	}
+	st->nb_cells = (long long) b->h*b->w;
+	return;
+}
@@ -0,0 +1,31 @@
+#ifndef _SOLVE_H_INCLUDED
+#define _SOLVE_H_INCLUDED
+
+/**
+ * \file solve.h
+ * \brief Distances and paths in a Board
+ */
+
+#include <stdlib.h>
+#include "data_struct.h"
+
+///\brief Default cells per thread below which par_bfs_distances() does not split a level
+#define PAR_MIN_CELLS 16
+
+///\brief Counts gathered by scan_board()
+typedef struct{
+	long long nb_cells; ///< \brief Number of cells
+	long long nb_open; ///< \brief Number of open walls
+	long long nb_closed; ///< \brief Cells with no way out
+	long long nb_dead_ends; ///< \brief Cells with one way out
+	long long nb_corridors; ///< \brief Cells with two ways out
+	long long nb_junctions; ///< \brief Cells with three or four ways out
+} BoardStats;
+
+int **new_distances(Board *);
+bool is_farther(int, Yx, int, Yx);
+int bfs_distances(Board *, Yx, int **, Yx *);
+int shortest_path(Board *, int **, Yx, Direction *);
+int par_bfs_distances(Board *, Yx, int **, Yx *, int, int);
+void scan_board(Board *, BoardStats *);
+#endif //_SOLVE_H_INCLUDED
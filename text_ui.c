@@ -1,4 +1,5 @@
 #include "text_ui.h"
+#include "movelog.h"
 
 //General UI functions
 ///\brief UI initialization
@@ -175,6 +176,7 @@ void move_player(UI *ui, Board *b, Player *plr, Direction dir){
 			erase_fill(ui, plr->c, opposite_dir(dir));
 		}
 		plr->nb_steps++;
+		if(plr->log != NULL) log_move(plr->log, dir);
 		print_player(ui, plr);
 	}
 